@@ -1,52 +1,83 @@
 // -----------------------------------------------------------------
 // Measure total action, as needed by the hybrid Monte Carlo algorithm
+// All sums are accumulated in double precision with compensated summation
+// bQM_hmc_mixed also measures the action here, on the double-precision
+// fields, so only its molecular dynamics is single precision (mixed_md.c)
 #include "bQM_includes.h"
 // -----------------------------------------------------------------
 
 
 
+// -----------------------------------------------------------------
+// Compensated (Kahan) summation: *c carries the low-order bits lost in *sum
+void kahan_sum(double *sum, double *c, double x) {
+  double y = x - *c, t = *sum + y;
+  *c = (t - *sum) - y;
+  *sum = t;
+}
+
+// Re Tr[X U Y Udag] for the hopping term on one site,
+// also used by the fused measurements in measure.c
+double site_hop_trace(matrix *X, matrix *U, matrix *Y) {
+  matrix tmat, tmat2;
+
+  mult_nn(U, Y, &tmat);
+  mult_na(&tmat, U, &tmat2);
+  return realtrace_nn(X, &tmat2);
+}
+// -----------------------------------------------------------------
+
+
+
 // -----------------------------------------------------------------
 // Bosonic contribution to the action
+// gemm_util.c replaces this with a BLAS version for GEMM_KERNELS
+#ifndef GEMM_KERNELS
 double bosonic_action() {
-  register int i,l;
+  register int i;
   register site *s;
-  int j, k;
-  double b_action = 0.0;
-  double sqterms = 0.0;
-  matrix tmat, tmat2;
+  int j;
+  double b_action = 0.0, hopterms = 0.0, c_hop = 0.0;
+  double sqterms = 0.0, c_sq = 0.0;
+  matrix tX, tX1;
   msg_tag *tag[NSCALAR];
 
   // Scalar kinetic term -Tr[D_t X(t)]^2
   //   -Tr[U(t) X(t+1) Udag(t) - X(t)]^2
   //     = Tr[2 X(t) U(t) X(t+1) Udag(t) - X(t+1) X(t+1) - X(t) X(t)]
   // Sum over t --> 2 Tr[Udag(t) X(t) U(t) X(t+1) - X(t) X(t)]
-  for (j = 0; j < NSCALAR; j++) {
-    tag[j] = start_gather_site(F_OFFSET(X[j]), sizeof(matrix),
+  // The compressed scalars are gathered, then uncompressed for the products
+  for (j = 0; j < nscalar; j++) {
+    tag[j] = start_gather_field(X[j], sizeof(anti_hermitmat),
                                TUP, EVENANDODD, gen_pt[j]);
   }
 
-  // On-site piece of scalar kinetic term
+  // On-site piece of scalar kinetic term, -Tr[X X] = Tr[Xdag X]
   FORALLSITES(i, s) {
-    for (j = 0; j < NSCALAR; j++)
-      sqterms -= (double)realtrace_nn(&(s->X[j]), &(s->X[j]));
+    for (j = 0; j < nscalar; j++)
+      kahan_sum(&sqterms, &c_sq, realtrace_ahmat(&(X[j][i]), &(X[j][i])));
   }
-  b_action = (2.0+omega*omega)*sqterms;
 
   // Nearest-neighbor piece of scalar kinetic term
-  for (j = 0; j < NSCALAR; j++) {
+  for (j = 0; j < nscalar; j++) {
+    TIC(T_GATHER)
     wait_gather(tag[j]);
+    TOC(T_GATHER, 0.0, GATHER_AH_BYTES)
     FORALLSITES(i, s) {
-
-      mult_nn(&(s->link), (matrix *)(gen_pt[j][i]), &tmat);
-      mult_na(&tmat, &(s->link), &tmat2);
-      b_action += 2.0*(double)realtrace_nn(&(s->X[j]), &tmat2);
+      uncompress_anti_hermitian(&(X[j][i]), &tX);
+      uncompress_anti_hermitian((anti_hermitmat *)(gen_pt[j][i]), &tX1);
+      kahan_sum(&hopterms, &c_hop, site_hop_trace(&tX, &(links[i]), &tX1));
     }
     cleanup_gather(tag[j]);
   }
+  b_action = (2.0 + omega * omega) * sqterms + 2.0 * hopterms;
 
+  TIC(T_REDUCE)
   g_doublesum(&b_action);
+  TOC(T_REDUCE, 0.0, REDUCE_BYTES)
   return beta*b_action;
 }
+#endif
 // -----------------------------------------------------------------
 
 
@@ -55,18 +86,18 @@ double bosonic_action() {
 // Gauge and scalar momenta contribution to the action
 // Helper routine computes magnitude squared of an anti-hermition matrix
 // including the factor of 1/2 in the effective hamiltonian
-Real ahmat_mag_sq(anti_hermitmat *ah) {
+double ahmat_mag_sq(anti_hermitmat *ah) {
   register int i;
-  register Real sum;
+  register double sum;
 
-  sum = ah->im_diag[0] * ah->im_diag[0];
+  sum = (double)ah->im_diag[0] * ah->im_diag[0];
   for (i = 1; i < NCOL; i++)
-    sum += ah->im_diag[i] * ah->im_diag[i];
+    sum += (double)ah->im_diag[i] * ah->im_diag[i];
   sum *= 0.5;
 
   for (i = 0; i < N_OFFDIAG; i++) {
-    sum += ah->m[i].real * ah->m[i].real;
-    sum += ah->m[i].imag * ah->m[i].imag;
+    sum += (double)ah->m[i].real * ah->m[i].real;
+    sum += (double)ah->m[i].imag * ah->m[i].imag;
   }
 
   return sum;
@@ -75,26 +106,30 @@ Real ahmat_mag_sq(anti_hermitmat *ah) {
 double gauge_mom_action() {
   register int i;
   register site *s;
-  double sum = 0.0;
+  double sum = 0.0, c = 0.0;
 
   FORALLSITES(i, s)
-    sum += (double)ahmat_mag_sq(&(s->mom));
+    kahan_sum(&sum, &c, ahmat_mag_sq(&(s->mom)));
 
+  TIC(T_REDUCE)
   g_doublesum(&sum);
+  TOC(T_REDUCE, 0.0, REDUCE_BYTES)
   return sum;
 }
 
 double scalar_mom_action() {
   register int i, j;
   register site *s;
-  double sum = 0.0;
+  double sum = 0.0, c = 0.0;
 
   FORALLSITES(i, s) {
-    for (j = 0; j < NSCALAR; j++)
-      sum += (double)realtrace(&(s->mom_X[j]), &(s->mom_X[j]));
+    for (j = 0; j < nscalar; j++)
+      kahan_sum(&sum, &c, ahmat_mag_sq(&(s->mom_X[j])));
   }
+  TIC(T_REDUCE)
   g_doublesum(&sum);
-  return 0.5 * sum;
+  TOC(T_REDUCE, 0.0, REDUCE_BYTES)
+  return sum;
 }
 // -----------------------------------------------------------------
 
@@ -103,20 +138,36 @@ double scalar_mom_action() {
 // -----------------------------------------------------------------
 // Print out zeros for pieces of the action that aren't included
 double action(matrix ***src, matrix ****sol) {
-  double p_act, so3_act, so6_act, comm_act, Myers_act, total;
+  double p_act, total;
+  double so3_act = 0.0, so6_act = 0.0, comm_act = 0.0, Myers_act = 0.0;
 
+  TIC(T_ACTION)
   // Includes so3, so6, Myers and kinetic
   total = bosonic_action();
   node0_printf("action: so3 %.8g so6 %.8g comm %.8g Myers %.8g boson %.8g ",
                so3_act, so6_act, comm_act, Myers_act, total);
+#ifdef PLOOP_BIAS
+  p_act = bias_action();
+  node0_printf("bias %.8g ", p_act);
+  total += p_act;
+#endif
 
+#ifdef STATIC_GAUGE
+  // Faddeev--Popov measure and momenta of the Polyakov loop eigenphases
+  p_act = vandermonde_action();
+  node0_printf("FP %.8g ", p_act);
+  total += p_act;
+  p_act = theta_mom_action();
+#else
   p_act = gauge_mom_action();
+#endif
   node0_printf("Umom %.8g ", p_act);
   total += p_act;
   p_act = scalar_mom_action();
   node0_printf("Xmom %.8g ", p_act);
   total += p_act;
   node0_printf("sum %.8g\n", total);
+  TOC(T_ACTION, sites_on_node * ACTION_FLOPS, sites_on_node * ACTION_BYTES)
   return total;
 }
 // -----------------------------------------------------------------
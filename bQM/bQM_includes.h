@@ -1,6 +1,7 @@
 // -----------------------------------------------------------------
 // Include files for supersymmetric evolution
 #include "../include/config.h"  // Keep this first
+#include "defines.h"            // Before macros.h, which checks TIMING
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
@@ -35,46 +36,192 @@ void setup_lambda();
 
 // Gaussian random momentum matrices and pseudofermions
 void ranmom();
+#ifdef GHMC
+void partial_ranmom();
+void flip_mom();
+#endif
 
 // Polyakov loop observables
 complex ploop();
 complex ploop_eig();
-// Use LAPACK to diagonalize Polyakov loop
-// http://www.physics.orst.edu/~rubin/nacphy/lapack/routines/zgeev.html
-// First two arguments turn off eigenvector computations
-// Third and fifth arguments are the dimensions of the matrix
-// Fourth argument is that matrix, which will be overwritten
-// Sixth argument holds the computed eigenvalues
-// Seventh and ninth arguments are eigenvectors
-// Eighth and tenth arguments are the dimensions of the eigenvectors
-// Eleventh argument is real workspace, of size given by the twelfth argument
-// Thirteenth argument is real workspace, of size given by the third argument
-// Final argument reports success or information about failure
-void zgeev_(char *doL, char *doR, int *N1, double *store, int *N2, double *eigs,
-            double *dumL, int *NL, double *dumR, int *NR,
-            double *work, int *Nwork, double *Rwork, int *stat);
+// Prefix transport along the line and the Polyakov loop on every node
+void line_prefix(matrix *P, matrix *L);
+// Eigenvalues of a unitary matrix (overwritten for NCOL > 3),
+// and their phases relative to the circular mean in ascending order
+void unitary_eigs(matrix *U, complex *e);
+void centre_phases(complex *e, double *phases);
 
 
 // Scalar eigenvalues: averages, extrema and width
 // #define SCALAR_EIG_DIST to print all eigenvalues in serial
 void scalar_eig(double *ave_eigs, double *eig_widths,
                 double *min_eigs, double *max_eigs);
+void scalar_eig_load(int i);
+void scalar_eig_local(double *sum, double *sq, double *min, double *max);
+
+// Scalar correlators C(0..MAX_T) on node0, see corr.c
+double *scalar_corr();
+
+// Eigenvalues of a batch of hermitian matrices in herm_eig.c
+void herm_eig_batch(matrix *H, int n, double *eigs);
 
 // Action routines
 double action();
 double bosonic_action();
+double site_hop_trace(matrix *X, matrix *U, matrix *Y);
+void kahan_sum(double *sum, double *c, double x);
 
 // Force routines
 double bosonic_force(Real eps);
 
+// Single-precision copies of the fields for MIXED_MD, see mixed_md.c
+#ifdef MIXED_MD
+void mixed_md_begin();
+void mixed_md_end();
+#endif
+
 // Compute average Tr[X[i] X[i]] / N_c
 double scalar_trace(double *Xtr, double *Xwidth);
 
+// Measurements scheduled by the meas_* input parameters, see measure.c
+// Each member is only set when the corresponding measurement is made
+typedef struct {
+  double Xtr[NSCALAR], Xtr_ave, Xtr_width;            // M_SCALAR_TRACE
+  double b_act, sqterms, hopterms, bias;              // M_ACTION
+  complex plp;                                        // M_PLOOP
+  double ave_eigs[NCOL_DIM], eig_widths[NCOL_DIM];    // M_SCALAR_EIG
+  double min_eigs[NCOL_DIM], max_eigs[NCOL_DIM];
+} meas_t;
+extern char *meas_tag[N_MEAS];
+int measure(int traj, meas_t *m);
+void measure_report(double sec_per_traj);
+void measure_adjust();
+int measure_thermalized(int traj);
+int measure_converged(double target);
+
+// Streaming mean, binned errors and jackknife for one observable,
+// see stats.c
+typedef struct {
+  long nb[STAT_LEVELS];               // Blocks completed at each level
+  double bmean[STAT_LEVELS], bm2[STAT_LEVELS];  // Welford mean and M2
+  double pend[STAT_LEVELS];           // First half of the next block
+  int half[STAT_LEVELS];              // Whether pend is set
+  double jsum[STAT_NJACK], jsq[STAT_NJACK];     // Full jackknife bins
+  int nj;                             // Number of full bins
+  long jsize, jn;                     // Bin size and fill of current bin
+  double jcur, jcur_sq;               // Current bin
+} stat_t;
+void stat_init(stat_t *st);
+void stat_add(stat_t *st, double x);
+long stat_count(stat_t *st);
+double stat_mean(stat_t *st);
+double stat_level_err(stat_t *st, int l);
+double stat_err(stat_t *st, int *level);
+void stat_jackknife(stat_t *st, double *mean_err, double *var,
+                    double *var_err);
+void stat_print(char *name, stat_t *st);
+
+// Streaming autocorrelation over a bounded history, see stats.c
+typedef struct {
+  long n;                             // Number of values
+  double shift, total;                // First value, sum of shifted values
+  double first[AC_WMAX], ring[AC_WMAX];         // First and last values
+  double S[AC_WMAX];                  // Sums of x_i x_{i-t}
+} acorr_t;
+void acorr_init(acorr_t *ac);
+void acorr_add(acorr_t *ac, double x);
+int acorr_tau(acorr_t *ac, double *tau, double *dtau, int *W);
+
+// MSER thermalization detection on batch means, see stats.c
+typedef struct {
+  int n, nmax;                        // Number of batches and room
+  int nin;                            // Values in the current batch
+  double cur;                         // Their sum
+  double *batch;                      // Batch means
+} therm_t;
+void therm_init(therm_t *th, int max_values);
+void therm_free(therm_t *th);
+void therm_add(therm_t *th, double x);
+int therm_mser(therm_t *th);
+
+// Eigenvalue histograms, see hist.c
+void hist_scalar(double *eigs);
+void hist_phases(double *phases);
+void hist_write();
+
+// Binary observable stream for reweighting, see obs.c
+void obs_record(int traj, int todo, meas_t *m);
+void obs_close();
+
 // Routines in library_util.c that loop over all sites
+void set_active_fields(int buf);
 #ifdef HMC_ALGORITHM
-void copy_bosons(int sign);
+void begin_proposal();
+void end_proposal(int accept);
 #endif
+int update_target();
+void finish_update(int buf);
 void shiftmat(matrix *dat, matrix *temp, int dir);
+
+// Exact heatbath for the scalars in scalar_gibbs.c
+// Uses LAPACK dpotrf (Cholesky factorization) and BLAS dtrsm (triangular
+// solve), dsyrk (C += alpha A A^T) and dgemm, all column-major
+#ifdef SCALAR_GIBBS
+void scalar_gibbs();
+void dpotrf_(char *uplo, int *N, double *A, int *ldA, int *stat);
+void dtrsm_(char *side, char *uplo, char *opA, char *diag, int *M, int *N,
+            double *alpha, double *A, int *ldA, double *B, int *ldB);
+void dsyrk_(char *uplo, char *op, int *N, int *K, double *alpha,
+            double *A, int *ldA, double *beta, double *C, int *ldC);
+void dgemm_(char *opA, char *opB, int *M, int *N, int *K, double *alpha,
+            double *A, int *ldA, double *B, int *ldB, double *beta,
+            double *C, int *ldC);
+#endif
+
+// Checkerboard heatbath for the scalars in scalar_heatbath.c
+#ifdef SCALAR_HEATBATH
+void scalar_heatbath();
+#endif
+
+// SU(2) subgroup Metropolis for the links in link_metropolis.c
+#ifdef LINK_METROPOLIS
+double link_metropolis();
+#endif
+
+// Bias potential on the Polyakov loop in bias.c
+#ifdef PLOOP_BIAS
+double bias_action();
+void bias_force(Real eps);
+void bias_update();
+#endif
+
+// Static diagonal gauge in static_gauge.c
+#ifdef STATIC_GAUGE
+void static_links(matrix *dest);
+void setup_static_gauge();
+void ranmom_theta();
+double theta_mom_action();
+double vandermonde_action();
+double static_gauge_force(Real eps);
+void traceless_theta(Real *v);
+#endif
+
+// Holonomy-only sampler in holonomy.c
+#ifdef HOLONOMY_ONLY
+double holonomy_action();
+double holonomy_force(Real eps);
+void holonomy_update();
+double holonomy_scalar_trace(double *Xtr, double *Xwidth);
+double holonomy_b_act();
+#endif
+
+// Kernel timers, used through TIC and TOC when compiled with TIMING
+#ifdef TIMING
+void timer_start(int id);
+void timer_stop(int id, double flops, double bytes);
+void timer_traj_report(int print);
+void timer_final_report();
+#endif
 // -----------------------------------------------------------------
 
 
@@ -93,4 +240,21 @@ void shiftmat(matrix *dat, matrix *temp, int dir);
 // Final argument reports success or information about failure
 void zheev_(char *doV, char *uplo, int *N1, double *store, int *N2,
             double *eigs, double *work, int *Nwork, double *Rwork, int *stat);
+
+// BLAS complex matrix products for the GEMM_KERNELS force and action
+// C = alpha op(A) op(B) + beta C in column-major order,
+// where op is set by the first two arguments ('N', 'T' or 'C')
+// Third through fifth arguments are the dimensions M, N and K
+// Complex scalars and matrices are stored as (real, imag) pairs
+#ifdef GEMM_KERNELS
+void zgemm_(char *opA, char *opB, int *M, int *N, int *K, double *alpha,
+            double *A, int *ldA, double *B, int *ldB, double *beta,
+            double *C, int *ldC);
+void cgemm_(char *opA, char *opB, int *M, int *N, int *K, float *alpha,
+            float *A, int *ldA, float *B, int *ldB, float *beta,
+            float *C, int *ldC);
+
+// GFLOP/s of one square n x n GEMM, see gemm_util.c
+double gemm_peak(int n);
+#endif
 // -----------------------------------------------------------------
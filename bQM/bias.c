@@ -0,0 +1,167 @@
+// -----------------------------------------------------------------
+// Bias potential on the Polyakov loop magnitude, compiled with PLOOP_BIAS
+// The HMC samples exp(-S - V(q)) with q = |Tr L| / N in [0, 1] for the
+// Polyakov loop L = U(0) U(1) ... U(nt - 1), where V is the sum of
+//   an umbrella    bias_kappa / 2 (q - bias_q0)^2        if bias_kappa > 0
+//   metadynamics   sum_k h_k exp(-(q - q_k)^2 / 2 w^2)   if bias_height > 0
+// with w = bias_width and a hill added at the current q every bias_stride
+// trajectories, of height
+//   h_k = bias_height exp(-V_hills(q_k) / bias_dT)
+// for well-tempered metadynamics if bias_dT > 0, and bias_height otherwise
+// The hills and their slope are kept on a grid of BIAS_BINS intervals
+// and interpolated linearly; the HMC stays exact since the accept/reject
+// test sees the same V as the molecular dynamics
+//
+// With P(t) = U(0) ... U(t - 1), the loop starting at t is
+// Q(t) = P(t)^dag L P(t), and moving U(t) -> (1 + T) U(t) changes
+//   Tr L -> Tr L + Tr[T Q(t)]
+// so each link feels V'(q) conj(Tr L) Q(t) / (N |Tr L|), projected onto
+// the algebra as for the bosonic force in update_h.c
+// Unless V'(0) = 0, V has a kink where Tr L vanishes, and trajectories
+// crossing it lose some acceptance
+// line_prefix() in ploop.c gives P(t) at this node's sites and L on every
+// node, exchanging only one matrix per node, so the bias costs each MD
+// step O(sites_on_node + number_of_nodes) matrix products per node
+//
+// After each trajectory bias_update() prints
+//   BIAS q V(q) nhills
+// where exp(V(q)) is the weight of the configuration in unbiased averages;
+// measure() also puts V(q) in the obs_file records for bQM_reweight
+#include "bQM_includes.h"
+
+#ifdef PLOOP_BIAS
+// Prefix transport at this node's sites, the Polyakov loop and its
+// trace, and the hills and their slope at q = b / BIAS_BINS
+// for b = 0, ..., BIAS_BINS
+static matrix *P = NULL, L;
+static complex trL;
+static double hill_V[BIAS_BINS + 1], hill_dV[BIAS_BINS + 1];
+static int nhills = 0, ntraj = 0;
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Build P(t) and L, returning q
+static double bias_line() {
+  if (P == NULL) {
+    P = malloc(sizeof *P * sites_on_node);
+    if (P == NULL) {
+      printf("bias_line: node%d can't malloc workspace\n", this_node);
+      terminate(1);
+    }
+  }
+
+  line_prefix(P, &L);
+  trL = trace(&L);
+  return cabs(&trL) * one_ov_N;
+}
+
+// Linear interpolation on the grid
+static double grid_at(double *grid, double q) {
+  int b;
+  double x = q * BIAS_BINS;
+
+  b = (int)floor(x);
+  if (b < 0)
+    b = 0;
+  else if (b > BIAS_BINS - 1)
+    b = BIAS_BINS - 1;
+  x -= (double)b;
+  return (1.0 - x) * grid[b] + x * grid[b + 1];
+}
+
+// Bias potential V(q) and its slope
+static double bias_potential(double q, double *dV) {
+  double V = 0.0;
+
+  *dV = 0.0;
+  if (bias_kappa > 0.0) {
+    V = 0.5 * bias_kappa * (q - bias_q0) * (q - bias_q0);
+    *dV = bias_kappa * (q - bias_q0);
+  }
+  if (nhills > 0) {
+    V += grid_at(hill_V, q);
+    *dV += grid_at(hill_dV, q);
+  }
+  return V;
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// V(q) for the current links, added to the action
+double bias_action() {
+  double q, V, dV;
+
+  TIC(T_BIAS)
+  q = bias_line();
+  V = bias_potential(q, &dV);
+  TOC(T_BIAS, LINE_FLOPS, LINE_BYTES)
+  return V;
+}
+
+// Update mom with the force from the bias
+// The direction of Tr L is undefined where it vanishes, and the
+// force is left out there
+void bias_force(Real eps) {
+  register int i;
+  register site *s;
+  double q, dV, mag;
+  complex c;
+  matrix tmat, Q;
+
+  TIC(T_BIAS)
+  q = bias_line();
+  bias_potential(q, &dV);
+  mag = cabs(&trL);
+  if (mag > SQ_TOL) {
+    // eps V'(q) conj(Tr L) / (N |Tr L|)
+    c.real = eps * dV * trL.real * one_ov_N / mag;
+    c.imag = -eps * dV * trL.imag * one_ov_N / mag;
+    FORALLSITES(i, s) {
+      mult_nn(&L, &(P[i]), &tmat);
+      mult_an(&(P[i]), &tmat, &Q);
+      uncompress_anti_hermitian(&(s->mom), &tmat);
+      c_scalar_mult_sum_mat(&Q, &c, &tmat);
+      make_anti_hermitian(&tmat, &(s->mom));
+    }
+  }
+  TOC(T_BIAS, LINE_FLOPS + sites_on_node * 2.0 * MATMUL_FLOPS,
+      LINE_BYTES + sites_on_node * 2.0 * AH_BYTES)
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Print the weight of the configuration after each trajectory and
+// add a hill every bias_stride trajectories
+void bias_update() {
+  register int b;
+  double q, V, dV, h, x, g, w2 = bias_width * bias_width;
+
+  TIC(T_BIAS)
+  q = bias_line();
+  V = bias_potential(q, &dV);
+  TOC(T_BIAS, LINE_FLOPS, LINE_BYTES)
+  node0_printf("BIAS %.8g %.8g %d\n", q, V, nhills);
+
+  ntraj++;
+  if (bias_height <= 0.0 || ntraj % bias_stride != 0)
+    return;
+  h = bias_height;
+  if (bias_dT > 0.0 && nhills > 0)
+    h *= exp(-grid_at(hill_V, q) / bias_dT);
+  for (b = 0; b <= BIAS_BINS; b++) {
+    x = (double)b / (double)BIAS_BINS - q;
+    g = h * exp(-0.5 * x * x / w2);
+    hill_V[b] += g;
+    hill_dV[b] -= g * x / w2;
+  }
+  nhills++;
+  node0_printf("BIAS_HILL %.8g %.8g\n", q, h);
+}
+#endif
+// -----------------------------------------------------------------
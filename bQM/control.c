@@ -7,12 +7,11 @@ int main(int argc, char *argv[]) {
   int prompt, j;
   int traj_done, Nmeas = 0;
   Real eps;
-  double b_act, dtime, Xtr[NSCALAR], Xtr_ave, Xtr_width;
+  double b_act, dtime, ttime, Xtr[NSCALAR], Xtr_ave, Xtr_width;
   double poloop_real=0;
   double poloop_imag=0;
   double poloop_abs=0;
-  double ave_eigs[NCOL], eig_widths[NCOL], min_eigs[NCOL], max_eigs[NCOL];
-  complex plp = cmplx(99.0, 99.0);
+  meas_t meas;
 
   // Setup
   setlinebuf(stdout); // DEBUG
@@ -39,67 +38,78 @@ int main(int argc, char *argv[]) {
 
   Xtr_ave = scalar_trace(Xtr, &Xtr_width);
   node0_printf("SCALAR SQUARES");
-  for (j = 0; j < NSCALAR; j++)
+  for (j = 0; j < nscalar; j++)
     node0_printf(" %.6g", Xtr[j]);
   node0_printf(" %.6g %.6g\n", Xtr_ave, Xtr_width);
 
   // Perform warmup trajectories
   eps = traj_length / (Real)nsteps;
   node0_printf("eps %.4g\n", eps);
-  for (traj_done = 0; traj_done < warms; traj_done++)
+#ifdef TIMING
+  timer_traj_report(0);   // Start the clocks
+#endif
+  // With therm_detect, warms is only the maximum
+  for (traj_done = 0; traj_done < warms; traj_done++) {
     update();
+#ifdef TIMING
+    timer_traj_report(0);
+#endif
+    if (therm_detect && measure_thermalized(traj_done))
+      break;
+  }
   node0_printf("WARMUPS COMPLETED\n");
 
   // Perform trajectories, reunitarizations and measurements
+  ttime = dclock();
   for (traj_done = 0; traj_done < trajecs; traj_done++) {
     update();
 
-    // Do "local" measurements every trajectory!
-    // Tr[X^2] / N
-    Xtr_ave = scalar_trace(Xtr, &Xtr_width);
-    //node0_printf("SCALAR SQUARES");
-    //for (j = 0; j < NSCALAR; j++)
-    //  node0_printf(" %.6g", Xtr[j]);
-    //node0_printf(" %.6g %.6g\n", Xtr_ave, Xtr_width);
-
-    // Polyakov loop eigenvalues and trace
-    // Format: GMES Re(Polyakov) Im(Poyakov)
-    plp = ploop_eig();
-    node0_printf("GMES %.8g %.8g\n", plp.real, plp.imag);
-    poloop_real += plp.real;
-    poloop_imag += plp.imag;
-    poloop_abs += sqrt(pow(plp.real,2)+pow(plp.imag,2));
-    node0_printf("Poloop RMS %.8g\n", sqrt(pow(plp.real,2)+pow(plp.imag,2)));
-    // Bosonic action
-    //b_act = bosonic_action(&(Xtr[0]), &(Xtr[1]), &(Xtr[2]), &(Xtr[3]));
-    b_act = bosonic_action();
-    node0_printf("b_act/nt %.8g\n",b_act / (double)nt);
-    //node0_printf("b_act/nt Xtr[0]/nt Xtr[1]/nt Xtr[2]/nt %.8g %.8g %.8g %.8g\n",
-    //             b_act / (double)nt, Xtr[0] / (double)nt,
-    //             Xtr[1] / (double)nt, Xtr[2] / (double)nt);
+    // Measurements scheduled by the meas_* input parameters,
+    // printing SCALAR SQUARES, LINES_EIG, GMES, Poloop RMS, b_act/nt,
+    // SCALAR_EIG and SCALAR_CORR as they are made
+    if (measure(traj_done, &meas) & MEAS_BIT(M_PLOOP)) {
+      poloop_real += meas.plp.real;
+      poloop_imag += meas.plp.imag;
+      poloop_abs += cabs(&(meas.plp));
+      Nmeas++;
+    }
+#ifdef TIMING
+    timer_traj_report(1);
+#endif
 
-    // Monitor scalar eigenvalues
-    // Format: SCALAR_EIG # ave width min max
-    //scalar_eig(ave_eigs, eig_widths, min_eigs, max_eigs);
-    //for (j = 0; j < NCOL; j++) {
-    //  node0_printf("SCALAR_EIG %d %.6g %.6g %.6g %.6g\n",
-    //               j, ave_eigs[j], eig_widths[j], min_eigs[j], max_eigs[j]);
-    //}
-
-    // Less frequent measurements every "propinterval" trajectories
-    // None at the moment
-//    if ((traj_done % propinterval) == (propinterval - 1)) {
-//    }
+    // Progress report every traj_between_meas trajectories, possibly
+    // adjusting the measurement spacing, with the histograms written out,
+    // and stop early once the target precision is reached
+    if (propinterval > 0 && (traj_done + 1) % propinterval == 0) {
+      measure_report((dclock() - ttime) / (double)(traj_done + 1));
+      measure_adjust();
+      hist_write();
+    }
+    if (stop_rel_err > 0.0 && measure_converged(stop_rel_err)) {
+      traj_done++;
+      node0_printf("STOP_REL_ERR %.4g reached after %d trajectories\n",
+                   stop_rel_err, traj_done);
+      break;
+    }
     fflush(stdout);
   }
   node0_printf("RUNNING COMPLETED\n");
-  node0_printf("GMES %.8g %.8g\n", poloop_real/(double)trajecs, poloop_imag/(double)trajecs);
-  node0_printf("Poloop RMS %.8g\n", poloop_abs/(double)trajecs);
+  if (Nmeas > 0) {
+    node0_printf("GMES %.8g %.8g\n", poloop_real / (double)Nmeas,
+                 poloop_imag / (double)Nmeas);
+    node0_printf("Poloop RMS %.8g\n", poloop_abs / (double)Nmeas);
+  }
+  measure_report((dclock() - ttime) / (double)traj_done);
+  hist_write();
+  obs_close();
   // Check: compute final bosonic action
   //b_act = bosonic_action(&(Xtr[0]), &(Xtr[1]), &(Xtr[2]), &(Xtr[3]));
   b_act = bosonic_action();
   node0_printf("STOP %.8g\n", b_act / (double)nt);
   dtime += dclock();
+#ifdef TIMING
+  timer_final_report();
+#endif
   node0_printf("\nTime = %.4g seconds\n", dtime);
   fflush(stdout);
 
@@ -0,0 +1,242 @@
+// -----------------------------------------------------------------
+// Main procedure for kernel microbenchmarks
+// Reads the same input as bQM_hmc, then times the library kernels
+// and the hot bQM routines on the resulting lattice
+// Output lines have the machine-readable format
+//   BENCH kernel ncol nt ns_per_site GFLOP/s GB/s bw_fraction
+// where bw_fraction compares GB/s with a STREAM triad measured here
+// With GEMM_KERNELS (bQM_bench_gemm) each line ends with a further
+//   peak_fraction
+// comparing GFLOP/s with one square GEMM_PEAK_SIZE ZGEMM (see gemm_peak()
+// in gemm_util.c), the most the stacked per-site products could reach
+#define CONTROL
+#include "bQM_includes.h"
+
+// Minimum time per measurement, and size of the STREAM arrays
+#define BENCH_MIN_TIME 0.2
+#define STREAM_SIZE (1 << 22)
+#define GEMM_PEAK_SIZE 1024
+
+// Kernels timed by bench_kernel
+enum { B_MULT_NN, B_MULT_NA, B_MULT_AN, B_SMADD, B_SMADD_AH, B_UNCMP_AH,
+       B_MAKE_AH, B_REUNIT, B_UPDATE_U, B_FORCE, B_ACTION, N_BENCH };
+static char *bench_name[N_BENCH] = {"mult_nn", "mult_na", "mult_an",
+                                    "scalar_mult_add_matrix",
+                                    "scalar_mult_add_ahmat",
+                                    "uncompress_anti_hermitian",
+                                    "make_anti_hermitian", "reunit",
+                                    "update_u", "bosonic_force",
+                                    "bosonic_action"};
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Best-case STREAM triad bandwidth in GB/s, a[i] = b[i] + s * c[i]
+double stream_triad() {
+  int i, rep;
+  double *a = malloc(sizeof *a * STREAM_SIZE);
+  double *b = malloc(sizeof *b * STREAM_SIZE);
+  double *c = malloc(sizeof *c * STREAM_SIZE);
+  double dtime, best = 1e30;
+
+  if (a == NULL || b == NULL || c == NULL) {
+    printf("stream_triad: malloc failed\n");
+    terminate(1);
+  }
+  for (i = 0; i < STREAM_SIZE; i++) {
+    b[i] = 1.0;
+    c[i] = 2.0;
+  }
+  for (rep = 0; rep < 5; rep++) {
+    dtime = -dclock();
+    for (i = 0; i < STREAM_SIZE; i++)
+      a[i] = b[i] + 0.5 * c[i];
+    dtime += dclock();
+    if (dtime < best)
+      best = dtime;
+  }
+  // Use the result so the loop can't be optimized away
+  if (a[STREAM_SIZE / 2] != 2.0)
+    node0_printf("stream_triad: unexpected result %.4g\n", a[STREAM_SIZE / 2]);
+
+  free(a);
+  free(b);
+  free(c);
+  return 3.0 * sizeof(double) * STREAM_SIZE / best * 1e-9;
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// One pass of the given kernel over all sites
+// The matrix kernels use the uncompressed X[0] in tempmat2
+// Returns estimated flops and bytes per site through the pointers
+void bench_pass(int kernel, anti_hermitmat *ah, double *flops,
+                double *bytes) {
+  register int i;
+  register site *s;
+
+  switch(kernel) {
+    case B_MULT_NN:
+      FORALLSITES(i, s)
+        mult_nn(&(links[i]), &(tempmat2[i]), &(tempmat[i]));
+      *flops = MATMUL_FLOPS;
+      *bytes = 3.0 * MAT_BYTES;
+      break;
+    case B_MULT_NA:
+      FORALLSITES(i, s)
+        mult_na(&(links[i]), &(tempmat2[i]), &(tempmat[i]));
+      *flops = MATMUL_FLOPS;
+      *bytes = 3.0 * MAT_BYTES;
+      break;
+    case B_MULT_AN:
+      FORALLSITES(i, s)
+        mult_an(&(links[i]), &(tempmat2[i]), &(tempmat[i]));
+      *flops = MATMUL_FLOPS;
+      *bytes = 3.0 * MAT_BYTES;
+      break;
+    case B_SMADD:
+      FORALLSITES(i, s)
+        scalar_mult_add_matrix(&(links[i]), &(tempmat2[i]), 0.5,
+                               &(tempmat[i]));
+      *flops = MATADD_FLOPS;
+      *bytes = 3.0 * MAT_BYTES;
+      break;
+    case B_SMADD_AH:
+      FORALLSITES(i, s)
+        scalar_mult_add_ahmat(&(X[0][i]), &(s->mom_X[0]), 0.5, &(ah[i]));
+      *flops = 2.0 * NCOL * NCOL;
+      *bytes = 3.0 * AH_BYTES;
+      break;
+    case B_UNCMP_AH:
+      FORALLSITES(i, s)
+        uncompress_anti_hermitian(&(s->mom), &(tempmat[i]));
+      *flops = 0.0;
+      *bytes = AH_BYTES + MAT_BYTES;
+      break;
+    case B_MAKE_AH:
+      FORALLSITES(i, s)
+        make_anti_hermitian(&(tempmat2[i]), &(ah[i]));
+      *flops = 3.0 * NCOL * NCOL;
+      *bytes = AH_BYTES + MAT_BYTES;
+      break;
+    case B_REUNIT:
+      reunitarize();
+      *flops = SVD_FLOPS;
+      *bytes = 2.0 * MAT_BYTES;
+      break;
+    case B_UPDATE_U:
+      update_u(1e-4);
+      *flops = UPDATE_U_FLOPS;
+      *bytes = UPDATE_U_BYTES;
+      break;
+    case B_FORCE:
+      bosonic_force(1e-4);
+      *flops = FORCE_FLOPS;
+      *bytes = FORCE_BYTES;
+      break;
+    case B_ACTION:
+      bosonic_action();
+      *flops = ACTION_FLOPS;
+      *bytes = ACTION_BYTES;
+      break;
+  }
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Find how many passes take BENCH_MIN_TIME on node0, then time that many
+// Many kernels call collectives, so every node must make the same passes:
+// node0 decides after each calibration pass whether to go on, and
+// broadcasts the decision
+void bench_kernel(int kernel, anti_hermitmat *ah, double stream_bw,
+                  double gemm_gflops) {
+  int j, reps = 0, more;
+  double dtime, flops, bytes, ns, gflops, gbs;
+
+  bench_pass(kernel, ah, &flops, &bytes);    // Warm the caches
+  g_sync();
+  dtime = -dclock();
+  do {
+    bench_pass(kernel, ah, &flops, &bytes);
+    reps++;
+    more = (dtime + dclock() < BENCH_MIN_TIME);
+    broadcast_bytes((char *)&more, sizeof more);
+  } while (more);
+
+  g_sync();
+  dtime = -dclock();
+  for (j = 0; j < reps; j++)
+    bench_pass(kernel, ah, &flops, &bytes);
+  dtime += dclock();
+  g_doublemax(&dtime);
+
+  ns = 1e9 * dtime / ((double)reps * sites_on_node);
+  gflops = flops / ns;
+  gbs = bytes / ns;
+  node0_printf("BENCH %-26s %d %d %.6g %.6g %.6g %.4f", bench_name[kernel],
+               NCOL, nt, ns, gflops, gbs, gbs / stream_bw);
+#ifdef GEMM_KERNELS
+  node0_printf(" %.4f", gflops / gemm_gflops);
+#endif
+  node0_printf("\n");
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+int main(int argc, char *argv[]) {
+  int prompt, kernel, i;
+  site *s;
+  double stream_bw, gemm_gflops = 0.0;
+  anti_hermitmat *ah;
+
+  // Setup
+  setlinebuf(stdout); // DEBUG
+  initialize_machine(&argc, &argv);
+  // Remap standard I/O
+  if (remap_stdio_from_args(argc, argv) == 1)
+    terminate(1);
+
+  g_sync();
+  prompt = setup();
+  setup_lambda();
+
+  // Load input and run
+  if (readin(prompt) != 0) {
+    node0_printf("ERROR in readin, aborting\n");
+    terminate(1);
+  }
+  FIELD_ALLOC(ah, anti_hermitmat);
+  ranmom();
+  FORALLSITES(i, s)
+    uncompress_anti_hermitian(&(X[0][i]), &(tempmat2[i]));
+
+  stream_bw = stream_triad();
+  g_doublemax(&stream_bw);
+  node0_printf("STREAM triad %.4g GB/s\n", stream_bw);
+#ifdef GEMM_KERNELS
+  gemm_gflops = gemm_peak(GEMM_PEAK_SIZE);
+  g_doublemax(&gemm_gflops);
+  node0_printf("ZGEMM peak %.4g GFLOP/s for n = %d\n", gemm_gflops,
+               GEMM_PEAK_SIZE);
+  node0_printf("BENCH kernel ncol nt ns_per_site GFLOP/s GB/s bw_fraction "
+               "peak_fraction\n");
+#else
+  node0_printf("BENCH kernel ncol nt ns_per_site GFLOP/s GB/s bw_fraction\n");
+#endif
+  for (kernel = 0; kernel < N_BENCH; kernel++)
+    bench_kernel(kernel, ah, stream_bw, gemm_gflops);
+  node0_printf("RUNNING COMPLETED\n");
+  fflush(stdout);
+
+  free(ah);
+  normal_exit(0);         // Needed by at least some clusters
+  return 0;
+}
+// -----------------------------------------------------------------
@@ -0,0 +1,86 @@
+// -----------------------------------------------------------------
+// Main procedure for the holonomy-only sampler, see holonomy.c
+// Reads the same input as bQM_hmc and prints the same measurement lines,
+// with SCALAR SQUARES and b_act/nt replaced by their exact expectation
+// values given the Polyakov loop eigenphases
+#define CONTROL
+#include "bQM_includes.h"
+
+int main(int argc, char *argv[]) {
+  int prompt, j;
+  int traj_done;
+  double b_act, dtime, Xtr[NSCALAR], Xtr_ave, Xtr_width;
+  double poloop_real = 0.0, poloop_imag = 0.0, poloop_abs = 0.0;
+  double Xtr_sum = 0.0;
+  complex plp = cmplx(99.0, 99.0);
+
+  // Setup
+  setlinebuf(stdout); // DEBUG
+  initialize_machine(&argc, &argv);
+  // Remap standard I/O
+  if (remap_stdio_from_args(argc, argv) == 1)
+    terminate(1);
+
+  g_sync();
+  prompt = setup();
+  setup_lambda();
+
+  // Load input and run
+  if (readin(prompt) != 0) {
+    node0_printf("ERROR in readin, aborting\n");
+    terminate(1);
+  }
+  dtime = -dclock();
+
+  b_act = holonomy_b_act();
+  node0_printf("START %.8g\n", b_act);
+  Xtr_ave = holonomy_scalar_trace(Xtr, &Xtr_width);
+  node0_printf("SCALAR SQUARES");
+  for (j = 0; j < nscalar; j++)
+    node0_printf(" %.6g", Xtr[j]);
+  node0_printf(" %.6g %.6g\n", Xtr_ave, Xtr_width);
+  node0_printf("eps %.4g\n", traj_length / (Real)nsteps);
+
+  for (traj_done = 0; traj_done < warms; traj_done++)
+    holonomy_update();
+  node0_printf("WARMUPS COMPLETED\n");
+
+  for (traj_done = 0; traj_done < trajecs; traj_done++) {
+    holonomy_update();
+
+    Xtr_ave = holonomy_scalar_trace(Xtr, &Xtr_width);
+    node0_printf("SCALAR SQUARES");
+    for (j = 0; j < nscalar; j++)
+      node0_printf(" %.6g", Xtr[j]);
+    node0_printf(" %.6g %.6g\n", Xtr_ave, Xtr_width);
+    Xtr_sum += Xtr_ave;
+
+    plp = ploop_eig();
+    node0_printf("GMES %.8g %.8g\n", plp.real, plp.imag);
+    poloop_real += plp.real;
+    poloop_imag += plp.imag;
+    poloop_abs += cabs(&plp);
+    node0_printf("Poloop RMS %.8g\n", cabs(&plp));
+    node0_printf("b_act/nt %.8g\n", b_act);
+    fflush(stdout);
+  }
+  node0_printf("RUNNING COMPLETED\n");
+  node0_printf("GMES %.8g %.8g\n", poloop_real / (double)trajecs,
+               poloop_imag / (double)trajecs);
+  node0_printf("Poloop RMS %.8g\n", poloop_abs / (double)trajecs);
+  hist_write();
+  node0_printf("SCALAR SQUARES %.8g\n", Xtr_sum / (double)trajecs);
+  node0_printf("STOP %.8g\n", b_act);
+  dtime += dclock();
+  node0_printf("\nTime = %.4g seconds\n", dtime);
+  fflush(stdout);
+
+  // Only the links are meaningful, for example to start bQM_hmc_static
+  if (saveflag != FORGET) {
+    static_links(links);
+    save_lattice(saveflag, savefile);
+  }
+  normal_exit(0);         // Needed by at least some clusters
+  return 0;
+}
+// -----------------------------------------------------------------
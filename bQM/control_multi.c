@@ -0,0 +1,115 @@
+// -----------------------------------------------------------------
+// Main procedure for bQM_hmc_multi and the other *_multi targets,
+// a single executable for all NCOL
+// Make_template builds the base target (bQM_hmc etc.) once for each of
+// NCOL = 2, 3 and 4 and once with NCOL_DYN, renaming their main to
+// bQM_main_2, bQM_main_3, bQM_main_4 and bQM_main_dyn and hiding
+// everything else they define
+// This reads ncol from the input and hands the whole run to the
+// matching instance, which then reads the input from the start
+// The NCOL_DYN instance covers 5 <= ncol <= NCOL_MAX, see ../include/bQM.h
+// Without a file name on the command line, node0 first copies stdin to
+// a temporary file, so that it can be read twice
+#include <stdio.h>
+#include <unistd.h>
+#ifdef MPI
+#include <mpi.h>
+#endif
+
+#define MULTI_LINE 1024
+
+int bQM_main_2(int argc, char *argv[]);
+int bQM_main_3(int argc, char *argv[]);
+int bQM_main_4(int argc, char *argv[]);
+int bQM_main_dyn(int argc, char *argv[]);
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Return ncol from the input, or 0 if it isn't there
+static int find_ncol(FILE *fp) {
+  int ncol = 0;
+  char line[MULTI_LINE];
+
+  while (fgets(line, MULTI_LINE, fp) != NULL) {
+    if (sscanf(line, " ncol %d", &ncol) == 1)
+      return ncol;
+  }
+  return 0;
+}
+
+// Copy stdin to a temporary file that then replaces it
+static int ncol_from_stdin() {
+  int ncol;
+  char line[MULTI_LINE];
+  FILE *fp = tmpfile();
+
+  if (fp == NULL) {
+    printf("Can't open a temporary file for stdin\n");
+    return 0;
+  }
+  while (fgets(line, MULTI_LINE, stdin) != NULL)
+    fputs(line, fp);
+  fflush(fp);
+  if (dup2(fileno(fp), fileno(stdin)) < 0) {
+    printf("Can't replace stdin\n");
+    return 0;
+  }
+  rewind(fp);
+  ncol = find_ncol(fp);
+  fclose(fp);
+  clearerr(stdin);
+  rewind(stdin);
+  return ncol;
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+int main(int argc, char *argv[]) {
+  int node = 0, ncol = 0;
+  FILE *fp;
+
+#ifdef MPI
+  // The instance's initialize_machine() leaves MPI as it is
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &node);
+#endif
+  if (node == 0) {
+    if (argc > 1) {
+      fp = fopen(argv[1], "r");
+      if (fp != NULL) {
+        ncol = find_ncol(fp);
+        fclose(fp);
+      }
+      else
+        printf("Can't open stdin file %s for reading\n", argv[1]);
+    }
+    else
+      ncol = ncol_from_stdin();
+    if (ncol < 2)
+      printf("No ncol in the input\n");
+  }
+#ifdef MPI
+  MPI_Bcast(&ncol, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  if (ncol < 2) {
+    MPI_Finalize();
+    return 1;
+  }
+#else
+  if (ncol < 2)
+    return 1;
+#endif
+
+  if (ncol == 2)
+    return bQM_main_2(argc, argv);
+  else if (ncol == 3)
+    return bQM_main_3(argc, argv);
+  else if (ncol == 4)
+    return bQM_main_4(argc, argv);
+  else
+    return bQM_main_dyn(argc, argv);
+}
+// -----------------------------------------------------------------
@@ -0,0 +1,315 @@
+// -----------------------------------------------------------------
+// Main procedure for reweighting the observable streams written by
+// bQM_hmc (obs.c) to other beta and omega
+// The action S = beta [(2 + omega^2) sqterms + 2 hopterms] depends on
+// the couplings only through the two recorded sums, so each sample n
+// can be given the weight at any (beta, omega)
+// With several streams from runs at different couplings, the
+// multi-histogram method of Ferrenberg and Swendsen combines them:
+//   w_n = exp(-S(n)) / sum_k N_k exp(-S_k(n) - ln Z_k)
+//   Z_k = sum_n exp(-S_k(n)) / sum_m N_m exp(-S_m(n) - ln Z_m)
+// iterated to self-consistency, which for a single stream reduces to
+// w_n = exp(S_0(n) - S(n))
+// Records from runs with the Polyakov loop bias (bias.c) get the extra
+// weight exp(V(n)); combining several streams this way assumes they
+// all share the same bias, which holds for a single stream, for a common
+// umbrella, and for slowly varying well-tempered metadynamics
+// Errors come from a jackknife over RW_NJACK blocks of consecutive
+// records in every stream, so they include autocorrelations longer
+// than a block
+// Input, after "prompt":
+//   nfiles 2
+//   obs_file run1.obs                   (nfiles times)
+//   beta_min 0.9 / beta_max 1.1 / nbeta 5
+//   omega_min 1 / omega_max 1 / nomega 1
+// Output, one line for each point of the grid:
+//   REWEIGHT beta omega N_eff b_act/nt err Xtr_ave err |P| err
+// where N_eff = (sum w)^2 / sum w^2 warns when the point is too far
+// from the runs to be trusted
+#define CONTROL
+#include "bQM_includes.h"
+
+#define RW_MAX_FILES 64
+#define RW_NJACK 20
+#define RW_TOL 1.0e-12
+#define RW_MAX_ITER 10000
+#define IF_OK if (status == 0)
+
+// Reweighted observables, Xtr_ave and |P| only from records with
+// their MEAS_BIT set
+enum { R_BACT, R_XTR, R_ABSP, N_RW };
+
+// Samples from all streams
+static int nfiles, nsamp = 0;
+static int Nk[RW_MAX_FILES];
+static double a_k[RW_MAX_FILES], b_k[RW_MAX_FILES], lnZ[RW_MAX_FILES];
+static double *sq, *hop, *bias, *obs[N_RW];
+static double *lnD[RW_NJACK + 1];     // Full sample, then each jackknife
+static int *mask, *file, *block;
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Append the records of one stream, returning 1 on error
+static int read_stream(char *name, int k) {
+  int header[4], n = 0, j, nrec;
+  double par[2], rec[OBS_NREC];
+  FILE *fp = fopen(name, "rb");
+
+  if (fp == NULL) {
+    printf("read_stream: can't open %s\n", name);
+    return 1;
+  }
+  if (fread(header, sizeof(int), 4, fp) != 4
+      || fread(par, sizeof(double), 2, fp) != 2
+      || header[0] < 1 || header[0] > OBS_VERSION) {
+    printf("read_stream: bad header in %s\n", name);
+    fclose(fp);
+    return 1;
+  }
+  if (k == 0)
+    nt = header[1];
+  else if (header[1] != nt) {
+    printf("read_stream: %s has nt %d, not %d\n", name, header[1], nt);
+    fclose(fp);
+    return 1;
+  }
+  a_k[k] = par[0] * (2.0 + par[1] * par[1]);
+  b_k[k] = 2.0 * par[0];
+
+  // Version 1 records end before the bias
+  nrec = (header[0] == 1 ? OBS_NREC - 1 : OBS_NREC);
+  rec[OBS_NREC - 1] = 0.0;
+  while (fread(rec, sizeof(double), nrec, fp) == nrec) {
+    sq = realloc(sq, sizeof *sq * (nsamp + 1));
+    hop = realloc(hop, sizeof *hop * (nsamp + 1));
+    bias = realloc(bias, sizeof *bias * (nsamp + 1));
+    mask = realloc(mask, sizeof *mask * (nsamp + 1));
+    file = realloc(file, sizeof *file * (nsamp + 1));
+    for (j = 0; j < N_RW; j++)
+      obs[j] = realloc(obs[j], sizeof *obs[j] * (nsamp + 1));
+    if (sq == NULL || hop == NULL || bias == NULL || mask == NULL
+        || file == NULL || obs[R_BACT] == NULL || obs[R_XTR] == NULL
+        || obs[R_ABSP] == NULL) {
+      printf("read_stream: can't realloc for %d samples\n", nsamp + 1);
+      terminate(1);
+    }
+    mask[nsamp] = (int)rec[1];
+    sq[nsamp] = rec[2];
+    hop[nsamp] = rec[3];
+    bias[nsamp] = rec[8];
+    obs[R_XTR][nsamp] = rec[4];
+    obs[R_ABSP][nsamp] = rec[7];
+    file[nsamp] = k;
+    nsamp++;
+    n++;
+  }
+  fclose(fp);
+  Nk[k] = n;
+  printf("READ %s beta %.6g omega %.6g %d records\n",
+         name, par[0], par[1], n);
+  return 0;
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// ln(exp(x) + exp(y)) without overflow
+static double log_add(double x, double y) {
+  if (x < y)
+    return y + log1p(exp(x - y));
+  return x + log1p(exp(y - x));
+}
+
+// Solve for ln Z_k leaving out jackknife block skip (none if -1),
+// keeping ln D(n) = ln sum_k N_k exp(-S_k(n) - ln Z_k) in lnD
+// ln Z_k from the previous call is the starting point
+static void wham(int skip, double *lnD) {
+  register int n, k;
+  int iter, N[RW_MAX_FILES];
+  double new[RW_MAX_FILES], td, change = 1.0;
+
+  for (k = 0; k < nfiles; k++)
+    N[k] = 0;
+  for (n = 0; n < nsamp; n++) {
+    if (block[n] != skip)
+      N[file[n]]++;
+  }
+
+  for (iter = 0; change > RW_TOL && iter < RW_MAX_ITER; iter++) {
+    for (n = 0; n < nsamp; n++) {
+      if (block[n] == skip)
+        continue;
+      lnD[n] = -1.0e300;
+      for (k = 0; k < nfiles; k++) {
+        td = log((double)N[k]) - a_k[k] * sq[n] - b_k[k] * hop[n] - lnZ[k];
+        lnD[n] = log_add(lnD[n], td);
+      }
+    }
+    if (nfiles == 1) {
+      change = 0.0;       // Nothing to solve for
+      break;
+    }
+
+    for (k = 0; k < nfiles; k++) {
+      new[k] = -1.0e300;
+      for (n = 0; n < nsamp; n++) {
+        if (block[n] != skip)
+          new[k] = log_add(new[k], -a_k[k] * sq[n] - b_k[k] * hop[n] - lnD[n]);
+      }
+    }
+    change = 0.0;
+    for (k = nfiles - 1; k >= 0; k--) {
+      new[k] -= new[0];   // Overall normalization is arbitrary
+      td = fabs(new[k] - lnZ[k]);
+      if (td > change)
+        change = td;
+      lnZ[k] = new[k];
+    }
+  }
+  if (change > RW_TOL)
+    printf("wham: no convergence after %d iterations\n", iter);
+}
+
+// Reweighted averages at S = a sqterms + b hopterms, leaving out
+// jackknife block skip, returning the effective number of samples
+// b_act/nt is evaluated at the new couplings
+static double average(double a, double b, int skip, double *lnD,
+                      double *ave) {
+  register int n, j;
+  double lw, shift = -1.0e300, w, sw[N_RW], swo[N_RW], s1 = 0.0, s2 = 0.0;
+
+  // Shift the largest log weight to zero
+  for (n = 0; n < nsamp; n++) {
+    if (block[n] != skip) {
+      lw = -a * sq[n] - b * hop[n] + bias[n] - lnD[n];
+      if (lw > shift)
+        shift = lw;
+    }
+  }
+  for (j = 0; j < N_RW; j++) {
+    sw[j] = 0.0;
+    swo[j] = 0.0;
+  }
+  for (n = 0; n < nsamp; n++) {
+    if (block[n] == skip)
+      continue;
+    w = exp(-a * sq[n] - b * hop[n] + bias[n] - lnD[n] - shift);
+    s1 += w;
+    s2 += w * w;
+    obs[R_BACT][n] = (a * sq[n] + b * hop[n]) / (double)nt;   // Scratch
+    for (j = 0; j < N_RW; j++) {
+      if (j == R_XTR && !(mask[n] & MEAS_BIT(M_SCALAR_TRACE)))
+        continue;
+      if (j == R_ABSP && !(mask[n] & MEAS_BIT(M_PLOOP)))
+        continue;
+      sw[j] += w;
+      swo[j] += w * obs[j][n];
+    }
+  }
+  for (j = 0; j < N_RW; j++)
+    ave[j] = (sw[j] > 0.0 ? swo[j] / sw[j] : 0.0);
+  return s1 * s1 / s2;
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+int main(int argc, char *argv[]) {
+  int prompt, status = 0, k, n, i, j, b, nbeta, nomega;
+  Real beta_min, beta_max, omega_min, omega_max;
+  double bt, om, neff, ave[N_RW], jk[RW_NJACK][N_RW], mean, err;
+  char name[MAXFILENAME];
+
+  initialize_machine(&argc, &argv);
+  if (remap_stdio_from_args(argc, argv) == 1)
+    terminate(1);
+
+  // Serial analysis
+  if (this_node != 0) {
+    normal_exit(0);
+    return 0;
+  }
+
+  status += get_prompt(stdin, &prompt);
+  IF_OK status += get_i(stdin, prompt, "nfiles", &nfiles);
+  if (nfiles < 1 || nfiles > RW_MAX_FILES) {
+    printf("nfiles must be between 1 and %d\n", RW_MAX_FILES);
+    terminate(1);
+  }
+  for (k = 0; k < nfiles; k++) {
+    IF_OK status += get_s(stdin, prompt, "obs_file", name);
+    IF_OK status += read_stream(name, k);
+  }
+  IF_OK status += get_f(stdin, prompt, "beta_min", &beta_min);
+  IF_OK status += get_f(stdin, prompt, "beta_max", &beta_max);
+  IF_OK status += get_i(stdin, prompt, "nbeta", &nbeta);
+  IF_OK status += get_f(stdin, prompt, "omega_min", &omega_min);
+  IF_OK status += get_f(stdin, prompt, "omega_max", &omega_max);
+  IF_OK status += get_i(stdin, prompt, "nomega", &nomega);
+  if (status > 0 || nsamp == 0) {
+    printf("ERROR in input, aborting\n");
+    terminate(1);
+  }
+
+  // Jackknife blocks of consecutive records within each stream
+  block = malloc(sizeof *block * nsamp);
+  for (b = 0; b <= RW_NJACK; b++) {
+    lnD[b] = malloc(sizeof *lnD[b] * nsamp);
+    if (lnD[b] == NULL || block == NULL) {
+      printf("Can't malloc for %d samples\n", nsamp);
+      terminate(1);
+    }
+  }
+  for (n = 0, k = 0; k < nfiles; k++) {
+    for (i = 0; i < Nk[k]; i++, n++)
+      block[n] = (int)((long)i * RW_NJACK / Nk[k]);
+  }
+
+  // Free energies of the runs for each jackknife sample,
+  // then with all samples
+  for (k = 0; k < nfiles; k++)
+    lnZ[k] = 0.0;
+  for (b = 0; b < RW_NJACK; b++)
+    wham(b, lnD[b + 1]);
+  wham(-1, lnD[0]);
+  for (k = 0; k < nfiles; k++)
+    printf("LNZ %d %.10g\n", k, lnZ[k]);
+
+  for (i = 0; i < nbeta; i++) {
+    bt = beta_min;
+    if (nbeta > 1)
+      bt += i * (beta_max - beta_min) / (nbeta - 1.0);
+    for (j = 0; j < nomega; j++) {
+      om = omega_min;
+      if (nomega > 1)
+        om += j * (omega_max - omega_min) / (nomega - 1.0);
+
+      // Full sample, then leave out each block in turn
+      neff = average(bt * (2.0 + om * om), 2.0 * bt, -1, lnD[0], ave);
+      for (b = 0; b < RW_NJACK; b++)
+        average(bt * (2.0 + om * om), 2.0 * bt, b, lnD[b + 1], jk[b]);
+
+      printf("REWEIGHT %.6g %.6g %.1f", bt, om, neff);
+      for (k = 0; k < N_RW; k++) {
+        mean = 0.0;
+        for (b = 0; b < RW_NJACK; b++)
+          mean += jk[b][k];
+        mean /= (double)RW_NJACK;
+        err = 0.0;
+        for (b = 0; b < RW_NJACK; b++)
+          err += (jk[b][k] - mean) * (jk[b][k] - mean);
+        err = sqrt(err * (RW_NJACK - 1.0) / (double)RW_NJACK);
+        printf(" %.8g %.4g", ave[k], err);
+      }
+      printf("\n");
+    }
+  }
+  fflush(stdout);
+  normal_exit(0);
+  return 0;
+}
+// -----------------------------------------------------------------
@@ -0,0 +1,195 @@
+// -----------------------------------------------------------------
+// Euclidean time correlators of the scalars for all separations
+//   C(tau) = sum_i sum_t Re Tr[X_i(t)^dag W X_i(t + tau) W^dag]
+//            / (N nt nscalar),  0 <= tau <= MAX_T
+// with W = U(t) ... U(t + tau - 1) the parallel transport along the line,
+// so that C(0) is the average of SCALAR SQUARES
+// With the prefix transport P(t) = U(0) ... U(t - 1),
+// W = P(t)^dag P(t + tau) and Y(t) = P(t) X(t) P(t)^dag, each term
+// is Re Tr[Y(t)^dag Y(t + tau)], where past the end of the line
+// P(t + tau) = L P(t + tau - nt) with L the Polyakov loop
+// Each node rotates its own scalars after line_prefix() in ploop.c,
+// and node0 collects the rotated line with a single g_vecdoublesum
+// C(tau) is then the correlation of Y(0), ..., Y(nt - 1) with
+//   Y(0), ..., Y(nt - 1), L Y(0) L^dag, ..., L Y(MAX_T - 1) L^dag
+// which radix-2 FFTs of length at least nt + MAX_T give for all tau
+// in O(nscalar N^2 nt log nt), rather than the O(nt^2) of shifts
+// Since Y is anti-hermitian, only the diagonal and upper triangle
+// (the latter weighted by two) are needed
+#include "bQM_includes.h"
+
+// Collected line, prefix transport at this node's sites, rotated
+// scalars, FFT buffers and result, allocated on first use
+static double *line = NULL, *corr;
+static matrix *P, *Y, L;
+static dcomplex *F, *G, *S;
+static int nfft;
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// In-place radix-2 FFT of length n, with exp(sign 2 pi i j k / n)
+static void fft(dcomplex *a, int n, int sign) {
+  register int i, j, k, len;
+  double ang;
+  dcomplex w, wl, u, v, tc;
+
+  // Bit reversal
+  for (i = 1, j = 0; i < n; i++) {
+    for (k = n >> 1; j & k; k >>= 1)
+      j ^= k;
+    j |= k;
+    if (i < j) {
+      tc = a[i];
+      a[i] = a[j];
+      a[j] = tc;
+    }
+  }
+
+  for (len = 2; len <= n; len <<= 1) {
+    ang = sign * 2.0 * PI / (double)len;
+    wl = dcmplx(cos(ang), sin(ang));
+    for (i = 0; i < n; i += len) {
+      w = dcmplx(1.0, 0.0);
+      for (k = 0; k < len / 2; k++) {
+        u = a[i + k];
+        CMUL(a[i + k + len / 2], w, v);
+        CADD(u, v, a[i + k]);
+        CSUB(u, v, a[i + k + len / 2]);
+        CMUL(w, wl, tc);
+        w = tc;
+      }
+    }
+  }
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Pack this node's rotated scalars Y(t) at their t,
+// 2 NCOL^2 doubles for each scalar
+#define LINE_STRIDE (2 * nscalar * NCOL * NCOL)
+static void collect_line() {
+  register int i, j, a;
+  register site *s;
+  double *d;
+  matrix tmat, tmat2, tY;
+
+  line_prefix(P, &L);
+  for (i = 0; i < nt * LINE_STRIDE; i++)
+    line[i] = 0.0;
+  FORALLSITES(i, s) {
+    d = line + s->t * LINE_STRIDE;
+    for (j = 0; j < nscalar; j++) {
+      uncompress_anti_hermitian(&(X[j][i]), &tmat);
+      mult_nn(&(P[i]), &tmat, &tmat2);
+      mult_na(&tmat2, &(P[i]), &tY);
+      for (a = 0; a < NCOL * NCOL; a++) {
+        *d++ = tY.e[a / NCOL][a % NCOL].real;
+        *d++ = tY.e[a / NCOL][a % NCOL].imag;
+      }
+    }
+  }
+  g_vecdoublesum(line, nt * LINE_STRIDE);
+}
+
+// Unpack rotated scalar j at time t
+static void line_scalar(int t, int j, matrix *m) {
+  register int a;
+  double *d = line + t * LINE_STRIDE + 2 * j * NCOL * NCOL;
+
+  for (a = 0; a < NCOL * NCOL; a++) {
+    m->e[a / NCOL][a % NCOL].real = *d++;
+    m->e[a / NCOL][a % NCOL].imag = *d++;
+  }
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Return C(0..MAX_T), only computed on node0
+double *scalar_corr() {
+  register int t, j, a, b, k;
+  int next = nt + MAX_T;
+  double wt, norm;
+  matrix tmat;
+  dcomplex tc;
+
+  if (line == NULL) {
+    for (nfft = 1; nfft < next; nfft <<= 1)
+      ;
+    line = malloc(sizeof *line * nt * LINE_STRIDE);
+    corr = malloc(sizeof *corr * (MAX_T + 1));
+    P = malloc(sizeof *P * sites_on_node);
+    if (this_node == 0) {
+      Y = malloc(sizeof *Y * next);
+      F = malloc(sizeof *F * nfft);
+      G = malloc(sizeof *G * nfft);
+      S = malloc(sizeof *S * nfft);
+    }
+    if (line == NULL || corr == NULL || P == NULL
+        || (this_node == 0 && (Y == NULL || F == NULL
+                               || G == NULL || S == NULL))) {
+      printf("scalar_corr: node%d can't malloc workspace\n", this_node);
+      terminate(1);
+    }
+  }
+
+  TIC(T_CORR)
+  collect_line();
+  for (t = 0; t <= MAX_T; t++)
+    corr[t] = 0.0;
+  if (this_node != 0) {
+    TOC(T_CORR, LINE_FLOPS + sites_on_node * 2.0 * nscalar * MATMUL_FLOPS,
+        LINE_BYTES + nt * LINE_STRIDE * sizeof(double))
+    return corr;
+  }
+
+  for (k = 0; k < nfft; k++)
+    S[k] = dcmplx(0.0, 0.0);
+  for (j = 0; j < nscalar; j++) {
+    // Rotated scalars and their extension past the end of the line
+    for (t = 0; t < nt; t++)
+      line_scalar(t, j, &(Y[t]));
+    for (t = nt; t < next; t++) {
+      mult_nn(&L, &(Y[t - nt]), &tmat);
+      mult_na(&tmat, &L, &(Y[t]));
+    }
+
+    // Accumulate conj(F) G over the independent elements
+    for (a = 0; a < NCOL; a++) {
+      for (b = a; b < NCOL; b++) {
+        wt = (a == b ? 1.0 : 2.0);
+        for (t = 0; t < nfft; t++) {
+          F[t] = dcmplx(0.0, 0.0);
+          G[t] = dcmplx(0.0, 0.0);
+        }
+        for (t = 0; t < nt; t++)
+          F[t] = dcmplx(Y[t].e[a][b].real, Y[t].e[a][b].imag);
+        for (t = 0; t < next; t++)
+          G[t] = dcmplx(Y[t].e[a][b].real, Y[t].e[a][b].imag);
+        fft(F, nfft, -1);
+        fft(G, nfft, -1);
+        for (k = 0; k < nfft; k++) {
+          CMULJ_(F[k], G[k], tc);
+          S[k].real += wt * tc.real;
+          S[k].imag += wt * tc.imag;
+        }
+      }
+    }
+  }
+
+  // Back to tau, with the 1 / nfft of the inverse transform
+  fft(S, nfft, 1);
+  norm = one_ov_N / ((double)nt * nscalar * nfft);
+  for (t = 0; t <= MAX_T; t++)
+    corr[t] = S[t].real * norm;
+  TOC(T_CORR, LINE_FLOPS + sites_on_node * 2.0 * nscalar * MATMUL_FLOPS
+              + CORR_FLOPS(nfft),
+      LINE_BYTES + nt * LINE_STRIDE * sizeof(double))
+  return corr;
+}
+// -----------------------------------------------------------------
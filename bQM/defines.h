@@ -4,12 +4,48 @@
 #define _DEFINES_H
 
 #define SITERAND              // Use site-based random number generators
-//#define TIMING              // Not currently used
+//#define TIMING              // Per-kernel timers, see timing.c
 //#define DEBUG_CHECK         // Print lambdas, offsets, etc.
 // -----------------------------------------------------------------
 
 
 
+// -----------------------------------------------------------------
+// Link-only molecular dynamics
+// scalar_gibbs() or scalar_heatbath() update the scalars before each
+// trajectory, which then keeps them fixed and moves only the links
+#if defined(SCALAR_GIBBS) || defined(SCALAR_HEATBATH)
+#define FIXED_SCALARS
+#endif
+
+// The exact harmonic rotation of the scalars is in update_o.c only,
+// and would move scalars that are meant to stay fixed
+#ifdef HARMONIC_SPLIT
+#if defined(FIXED_SCALARS) || defined(STATIC_GAUGE)
+#error "HARMONIC_SPLIT needs scalars moved by update_u() in update_o.c"
+#endif
+#endif
+
+// The Polyakov loop bias acts on general links, and its force is only
+// added by update_leapfrog.c
+#ifdef PLOOP_BIAS
+#if defined(STATIC_GAUGE) || defined(HARMONIC_SPLIT)
+#error "PLOOP_BIAS needs general links and update_leapfrog.c"
+#endif
+#endif
+
+// The single-precision molecular dynamics in mixed_md.c covers the
+// plain leapfrog with the library force only
+#ifdef MIXED_MD
+#if defined(FIXED_SCALARS) || defined(STATIC_GAUGE) \
+    || defined(HARMONIC_SPLIT) || defined(GEMM_KERNELS) || defined(PLOOP_BIAS)
+#error "MIXED_MD needs update_leapfrog.c with the force of update_h.c"
+#endif
+#endif
+// -----------------------------------------------------------------
+
+
+
 // -----------------------------------------------------------------
 // Integrator stuff
 // Omelyan lambda, 2lambda and 1 - 2lambda
@@ -27,7 +63,117 @@
 #define IMAG_TOL 1.0e-8
 #define SQ_TOL 1.0e-16
 
-// Maximum time value and spatial distance for Wilson loops
+// Maximum time separation for Wilson loops and correlators in corr.c
 #define MAX_T (nt / 2)
+
+// Observables scheduled by measure.c, each made every
+// meas_every[id] trajectories as read from the input (never if zero)
+enum meas_id { M_SCALAR_TRACE, M_ACTION, M_PLOOP, M_SCALAR_EIG, M_CORR,
+               N_MEAS };
+#define MEAS_BIT(id) (1 << (id))
+
+// Streaming statistics in stats.c: number of binning levels (up to 2^31
+// measurements), of jackknife bins, and of blocks needed for a level
+// to give a binned error
+#define STAT_LEVELS 32
+#define STAT_NJACK 32
+#define STAT_MIN_BLOCKS 32
+
+// Autocorrelations in stats.c: longest window, in units of the spacing
+// between measurements, and the Madras--Sokal factor W >= AC_C tau_int
+#define AC_WMAX 256
+#define AC_C 6.0
+
+// Thermalization detection in stats.c: batch size for the MSER rule,
+// and the number of batches before it is applied
+#define THERM_BATCH 5
+#define THERM_MIN_BATCHES 10
+
+// Bins in each eigenvalue histogram in hist.c
+#define HIST_BINS 1024
+
+// Version and record length of the binary observable stream in obs.c
+#define OBS_VERSION 2
+#define OBS_NREC 9
+
+// Intervals of the grid for q = |Tr L| / N in [0, 1] holding the
+// metadynamics hills in bias.c
+#define BIAS_BINS 1024
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Timers used by TIC and TOC, see timing.c
+enum timer_id { T_UPDATE_U, T_FORCE, T_REUNIT, T_REAH, T_RANMOM, T_ACTION,
+                T_PLOOP_EIG, T_GIBBS, T_HEATBATH,
+                T_LINK_METRO, T_SCALAR_EIG, T_MEASURE, T_CORR, T_BIAS,
+                T_GATHER, T_REDUCE, N_TIMERS };
+
+// Rough per-site flop and byte counts for the timed kernels
+// MATMUL_FLOPS is one NCOLxNCOL complex matrix product,
+// MATADD_FLOPS is one real-scalar multiply-add of complex matrices
+// SVD_FLOPS is a crude estimate for the LAPACK zgesvd call
+#define MATMUL_FLOPS (8.0 * NCOL * NCOL * NCOL)
+#define MATADD_FLOPS (4.0 * NCOL * NCOL)
+#define SVD_FLOPS (100.0 * NCOL * NCOL * NCOL)
+#define MAT_BYTES ((double)sizeof(matrix))
+#define AH_BYTES ((double)sizeof(anti_hermitmat))
+
+#define UPDATE_U_FLOPS (8.0 * MATMUL_FLOPS + 8.0 * MATADD_FLOPS \
+                        + 2.0 * nscalar * NCOL * NCOL)
+#define UPDATE_U_BYTES ((1.0 + 3.0 * nscalar) * AH_BYTES + 2.0 * MAT_BYTES)
+#ifdef GEMM_KERNELS  // Six stacked products per site, see gemm_util.c
+#define FORCE_FLOPS (nscalar * (6.0 * MATMUL_FLOPS + 6.0 * NCOL * NCOL) \
+                     + 3.0 * MATADD_FLOPS)
+#else
+#define FORCE_FLOPS (nscalar * (7.0 * MATMUL_FLOPS + 6.0 * NCOL * NCOL) \
+                     + 3.0 * MATADD_FLOPS)
+#endif
+#define FORCE_BYTES ((2.0 + 6.0 * nscalar) * AH_BYTES + 3.0 * MAT_BYTES)
+#define ACTION_FLOPS (nscalar * (2.0 * MATMUL_FLOPS + MATADD_FLOPS \
+                                 + 2.0 * NCOL * NCOL))
+#define ACTION_BYTES ((1.0 + 2.0 * nscalar) * AH_BYTES + MAT_BYTES)
+// Adjoint link per site, plus node 0's block Cholesky and solve per
+// time slice, which dominate the time whenever NADJ is large
+#define GIBBS_FLOPS (2.0 * NADJ * (MATMUL_FLOPS + 2.0 * NCOL * NCOL) \
+                     + 3.0 * NADJ * NADJ * NADJ \
+                     + 2.0 * nscalar * NADJ * (3.0 * NADJ + NCOL * NCOL))
+#define GIBBS_BYTES (MAT_BYTES + nscalar * AH_BYTES \
+                     + 4.0 * NADJ * NADJ * sizeof(double))
+// One full checkerboard sweep, counting both half-sweeps
+#define HEATBATH_FLOPS (nscalar * (4.0 * MATMUL_FLOPS + 8.0 * NCOL * NCOL))
+#define HEATBATH_BYTES (MAT_BYTES + 5.0 * nscalar * AH_BYTES)
+// Closed forms for NCOL <= 3, otherwise a few Jacobi sweeps,
+// each NCOL (NCOL - 1) / 2 rotations costing about 20 NCOL
+#if (NCOL_PP <= 3)
+#define SCALAR_EIG_FLOPS (10.0 * NCOL * NCOL)
+#else
+#define SCALAR_EIG_FLOPS (6.0 * 10.0 * NCOL * NCOL * (NCOL - 1))
+#endif
+// Fused measurement sweep: the action's hopping term and the traces
+#define MEASURE_FLOPS (nscalar * (2.0 * MATMUL_FLOPS + 4.0 * NCOL * NCOL))
+#define MEASURE_BYTES (MAT_BYTES + 2.0 * nscalar * AH_BYTES)
+// One Metropolis sweep over the NCOL (NCOL - 1) / 2 subgroups, each
+// rotating rows and columns p and q of every V_j and taking a trace
+#define LINK_METRO_FLOPS (0.5 * NCOL * (NCOL - 1) \
+                          * nscalar * (56.0 * NCOL + 8.0 * NCOL * NCOL))
+#define LINK_METRO_BYTES (2.0 * MAT_BYTES + 2.0 * nscalar * AH_BYTES)
+// Whole line_prefix() in ploop.c, not per site: products along this
+// node's block and the transport to its start, then the block products
+#define LINE_FLOPS ((2.0 * sites_on_node + number_of_nodes) * MATMUL_FLOPS)
+#define LINE_BYTES ((2.0 * sites_on_node + number_of_nodes) * MAT_BYTES)
+// Whole correlator measurement on node0, not per site: the extension of
+// the rotated scalars past the end of the line, then two FFTs of length
+// n for each independent element of each scalar, and one more for the
+// inverse; each node also rotates its own scalars after line_prefix()
+#define CORR_FLOPS(n) (2.0 * nscalar * MAX_T * MATMUL_FLOPS \
+                       + (nscalar * NCOL * (NCOL + 1.0) + 1.0) \
+                         * 5.0 * (n) * log2((double)(n)))
+
+// Each node exchanges a single boundary site per gather in one dimension
+#define GATHER_BYTES (number_of_nodes > 1 ? MAT_BYTES : 0.0)
+#define GATHER_AH_BYTES (number_of_nodes > 1 ? AH_BYTES : 0.0)
+#define REDUCE_BYTES ((double)sizeof(double))
 #endif
 // -----------------------------------------------------------------
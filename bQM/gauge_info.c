@@ -25,6 +25,8 @@ void write_appl_gauge_info(FILE *fp) {
   // The required magic number, time stamp, and lattice dimensions
   // have already been written
   // The rest are optional
+  // The file always holds NSCALAR scalars, only nscalar of them in use
+  write_gauge_info_item(fp, "nscalar", "%d", (char *)&nscalar, 0, 0);
   if (startlat_p != NULL) {
     // To retain some info about the original (or previous) configuration
     write_gauge_info_item(fp, "gauge.previous.filename","\"%s\"",
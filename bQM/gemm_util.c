@@ -0,0 +1,328 @@
+// -----------------------------------------------------------------
+// Large-N bosonic force and action using BLAS matrix products
+// Compiled with GEMM_KERNELS in place of the versions in update_h.c
+// and action.c, which call the NCOLxNCOL library routines once per
+// scalar and site
+//
+// At each site the nscalar uncompressed scalars are stacked into a
+// single (NCOL nscalar)xNCOL or NCOLx(NCOL nscalar) block, so that
+// each conjugation by the link becomes one GEMM call for all scalars:
+//   vertical stack  [X_0; X_1; ...] * U   multiplies each X_j on the right
+//   horizontal stack U * [X_0 X_1 ...]    multiplies each X_j on the left
+//   [A_0 A_1 ...] * [B_0; B_1; ...]       sums A_j B_j over the scalars
+// The stacks for one site stay in cache between the calls
+// The stacks are packed, while links and f_U are read and written in
+// place with rows LDM apart, which for NCOL_DYN includes their padding
+#include "bQM_includes.h"
+
+#ifdef GEMM_KERNELS
+#if (PRECISION == 1)
+#define GEMM cgemm_
+#else
+#define GEMM zgemm_
+#endif
+
+// Per-site workspace, four stacks of NSCALAR matrices
+#define STACK_SIZE (NCOL * NCOL * NSCALAR)
+#define LDM NCOL_DIM
+static complex *stack[4] = {NULL, NULL, NULL, NULL};
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Allocate the workspace on first use
+static void alloc_stacks() {
+  int k;
+
+  if (stack[0] != NULL)
+    return;
+  for (k = 0; k < 4; k++) {
+    stack[k] = malloc(STACK_SIZE * sizeof(complex));
+    if (stack[k] == NULL) {
+      printf("alloc_stacks: node%d can't malloc workspace\n", this_node);
+      terminate(1);
+    }
+  }
+}
+
+// Row-major c = op(a) op(b) + beta c, where op is 'N' or 'C' (adjoint)
+// and op(a) is m x k, op(b) is k x n, with leading dimensions lda etc.
+// BLAS sees the row-major arrays transposed, so swap the operands
+// to compute c^T = op(b)^T op(a)^T in column-major order
+static void gemm_rm(char ta, char tb, int m, int n, int k,
+                    complex *a, int lda, complex *b, int ldb,
+                    Real beta, complex *c, int ldc) {
+  Real one[2] = {1.0, 0.0}, bet[2] = {beta, 0.0};
+
+  GEMM(&tb, &ta, &n, &m, &k, one, (Real *)b, &ldb, (Real *)a, &lda,
+       bet, (Real *)c, &ldc);
+}
+
+// Copy a vertical stack of nX matrices into a horizontal stack
+static void v_to_h(complex *v, complex *h, int nX) {
+  register int j, a;
+  int ld = NCOL * nX;
+
+  for (j = 0; j < nX; j++) {
+    for (a = 0; a < NCOL; a++)
+      memcpy(h + a * ld + j * NCOL, v + (j * NCOL + a) * NCOL,
+             NCOL * sizeof(complex));
+  }
+}
+
+// Copy matrix j out of a horizontal stack of nX matrices
+static void h_to_mat(complex *h, int j, int nX, matrix *m) {
+  register int a;
+  int ld = NCOL * nX;
+
+  for (a = 0; a < NCOL; a++)
+    memcpy(m->e[a], h + a * ld + j * NCOL, NCOL * sizeof(complex));
+}
+
+// Uncompress a into the NCOL * NCOL packed elements at v,
+// through a padded matrix for NCOL_DYN
+static void uncompress_to_stack(anti_hermitmat *a, complex *v) {
+#ifdef NCOL_DYN
+  register int r;
+  matrix tmat;
+
+  uncompress_anti_hermitian(a, &tmat);
+  for (r = 0; r < NCOL; r++)
+    memcpy(v + r * NCOL, tmat.e[r], NCOL * sizeof(complex));
+#else
+  uncompress_anti_hermitian(a, (matrix *)v);
+#endif
+}
+
+// Vertical stack of the uncompressed scalars src[j][i]
+static void stack_scalars(anti_hermitmat **src, int i, complex *v) {
+  register int j;
+
+  for (j = 0; j < nscalar; j++)
+    uncompress_to_stack(&(src[j][i]), v + j * NCOL * NCOL);
+}
+
+// Same for the gathered scalars gen_pt[j][i]
+static void stack_gathered(int i, complex *v) {
+  register int j;
+
+  for (j = 0; j < nscalar; j++)
+    uncompress_to_stack((anti_hermitmat *)(gen_pt[j][i]),
+                        v + j * NCOL * NCOL);
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Update mom with the bosonic force
+// Same terms and normalization as update_h.c:
+//   f_U(n) = sum_j X_j(n) U(n) X_j(n+1) Udag(n)
+//   f_X_j(n) = U(n) X_j(n+1) Udag(n) - (2+omega^2) X_j(n)
+//            + Udag(n-1) X_j(n-1) U(n-1)
+// With W_j = X_j(n) U(n) and T_j = X_j(n+1) Udag(n), six GEMMs per site:
+//   W = [X_j] U,  Udag [W_j] (gathered backward),  W again after gathers,
+//   T = [X_j(n+1)] Udag,  f_U = [W_j] [T_j],  U [T_j] (forward term)
+double bosonic_force(Real eps) {
+  register int i, j;
+  register site *s;
+  int nN = nscalar * NCOL;
+  Real tr, tr2;
+  double returnit = 0.0;
+  matrix tmat;
+  anti_hermitmat f_X;
+  msg_tag *tag[NSCALAR], *tag2[NSCALAR];
+
+  TIC(T_FORCE)
+  alloc_stacks();
+  for (j = 0; j < nscalar; j++) {
+    tag[j] = start_gather_field(X[j], sizeof(anti_hermitmat),
+                               TUP, EVENANDODD, gen_pt[j]);
+  }
+
+  // Udag(n-1) X(n-1) U(n-1) for the backward scalar force term,
+  // computed while X(n+1) is gathered
+  FORALLSITES(i, s) {
+    stack_scalars(X, i, stack[0]);
+    gemm_rm('N', 'N', nN, NCOL, NCOL, stack[0], NCOL,
+            (complex *)&(links[i]), LDM, 0.0, stack[1], NCOL);
+    v_to_h(stack[1], stack[2], nscalar);
+    gemm_rm('C', 'N', NCOL, nN, NCOL, (complex *)&(links[i]), LDM,
+            stack[2], nN, 0.0, stack[3], nN);
+    for (j = 0; j < nscalar; j++) {
+      h_to_mat(stack[3], j, nscalar, &tmat);
+      compress_anti_hermitian(&tmat, &(temp_X[j][i]));
+    }
+  }
+  for (j = 0; j < nscalar; j++) {
+    tag2[j] = start_gather_field(temp_X[j], sizeof(anti_hermitmat),
+                                 TDOWN, EVENANDODD, gen_pt[NSCALAR + j]);
+  }
+  TIC(T_GATHER)
+  for (j = 0; j < nscalar; j++) {
+    wait_gather(tag[j]);
+    wait_gather(tag2[j]);
+  }
+  TOC(T_GATHER, 0.0, 2.0 * nscalar * GATHER_AH_BYTES)
+
+  // Gauge force and all scalar forces in a single sweep
+  tr = -2.0 - omega * omega;
+  tr2 = 2.0 * eps * beta;
+  FORALLSITES(i, s) {
+    // stack[2] = [W_j] horizontal, stack[1] = [T_j] vertical
+    stack_scalars(X, i, stack[0]);
+    gemm_rm('N', 'N', nN, NCOL, NCOL, stack[0], NCOL,
+            (complex *)&(links[i]), LDM, 0.0, stack[1], NCOL);
+    v_to_h(stack[1], stack[2], nscalar);
+    stack_gathered(i, stack[0]);
+    gemm_rm('N', 'C', nN, NCOL, NCOL, stack[0], NCOL,
+            (complex *)&(links[i]), LDM, 0.0, stack[1], NCOL);
+    gemm_rm('N', 'N', NCOL, NCOL, nN, stack[2], nN, stack[1], NCOL,
+            0.0, (complex *)&(s->f_U), LDM);
+
+    // Forward hopping terms U [T_j], then as in update_h.c
+    v_to_h(stack[1], stack[2], nscalar);
+    gemm_rm('N', 'N', NCOL, nN, NCOL, (complex *)&(links[i]), LDM,
+            stack[2], nN, 0.0, stack[3], nN);
+    for (j = 0; j < nscalar; j++) {
+      h_to_mat(stack[3], j, nscalar, &tmat);
+      make_anti_hermitian(&tmat, &f_X);
+#ifndef HARMONIC_SPLIT     // On-site term integrated exactly in update_o.c
+      scalar_mult_sum_ahmat(&(X[j][i]), tr, &f_X);
+#endif
+      scalar_mult_sum_ahmat((anti_hermitmat *)(gen_pt[NSCALAR + j][i]), 1.0,
+                            &f_X);
+      scalar_mult_sum_ahmat(&f_X, tr2, &(s->mom_X[j]));
+      returnit += 4.0 * realtrace_ahmat(&f_X, &f_X);
+    }
+  }
+  for (j = 0; j < nscalar; j++) {
+    cleanup_gather(tag[j]);
+    cleanup_gather(tag2[j]);
+  }
+
+  // Update the gauge momenta, as in update_h.c
+#ifdef STATIC_GAUGE
+  // Only the eigenphases feel the gauge force
+  // Already summed over nodes, so count it on one node
+  tr = static_gauge_force(eps);
+  if (this_node == 0)
+    returnit += tr;
+#else
+  tr = 4.0 * eps * beta; // !!!
+  FORALLSITES(i, s) {
+    uncompress_anti_hermitian(&(s->mom), &tmat);
+    scalar_mult_dif_matrix(&(s->f_U), tr, &tmat);
+    make_anti_hermitian(&tmat, &(s->mom));
+    returnit += 16.0 * realtrace(&(s->f_U), &(s->f_U));
+  }
+#endif
+  TIC(T_REDUCE)
+  g_doublesum(&returnit);
+  TOC(T_REDUCE, 0.0, REDUCE_BYTES)
+
+  TOC(T_FORCE, sites_on_node * FORCE_FLOPS, sites_on_node * FORCE_BYTES)
+  return (eps * beta * sqrt(returnit) / (double)nt);
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Bosonic contribution to the action, as in action.c
+// The hopping term Re Tr[X_j(n) U(n) X_j(n+1) Udag(n)] = Re Tr[W_j T_j]
+// needs only the two GEMMs for W and T at each site
+double bosonic_action() {
+  register int i, j, a, b;
+  register site *s;
+  int nN = nscalar * NCOL;
+  double b_action, site_hop, hopterms = 0.0, c_hop = 0.0;
+  double sqterms = 0.0, c_sq = 0.0;
+  complex *W, *T;
+  msg_tag *tag[NSCALAR];
+
+  alloc_stacks();
+  for (j = 0; j < nscalar; j++) {
+    tag[j] = start_gather_field(X[j], sizeof(anti_hermitmat),
+                               TUP, EVENANDODD, gen_pt[j]);
+  }
+  FORALLSITES(i, s) {
+    for (j = 0; j < nscalar; j++)
+      kahan_sum(&sqterms, &c_sq, realtrace_ahmat(&(X[j][i]), &(X[j][i])));
+  }
+  TIC(T_GATHER)
+  for (j = 0; j < nscalar; j++)
+    wait_gather(tag[j]);
+  TOC(T_GATHER, 0.0, nscalar * GATHER_AH_BYTES)
+
+  FORALLSITES(i, s) {
+    W = stack[1];
+    T = stack[2];
+    stack_scalars(X, i, stack[0]);
+    gemm_rm('N', 'N', nN, NCOL, NCOL, stack[0], NCOL,
+            (complex *)&(links[i]), LDM, 0.0, W, NCOL);
+    stack_gathered(i, stack[0]);
+    gemm_rm('N', 'C', nN, NCOL, NCOL, stack[0], NCOL,
+            (complex *)&(links[i]), LDM, 0.0, T, NCOL);
+
+    // Both vertical stacks, so W_j[a][b] T_j[b][a] is summed over j
+    site_hop = 0.0;
+    for (j = 0; j < nN; j += NCOL) {
+      for (a = 0; a < NCOL; a++) {
+        for (b = 0; b < NCOL; b++) {
+          site_hop += W[(j + a) * NCOL + b].real * T[(j + b) * NCOL + a].real
+                    - W[(j + a) * NCOL + b].imag * T[(j + b) * NCOL + a].imag;
+        }
+      }
+    }
+    kahan_sum(&hopterms, &c_hop, site_hop);
+  }
+  for (j = 0; j < nscalar; j++)
+    cleanup_gather(tag[j]);
+  b_action = (2.0 + omega * omega) * sqterms + 2.0 * hopterms;
+
+  TIC(T_REDUCE)
+  g_doublesum(&b_action);
+  TOC(T_REDUCE, 0.0, REDUCE_BYTES)
+  return beta*b_action;
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Best-case GFLOP/s of a single square n x n x n GEMM, the reference
+// against which bQM_bench_gemm compares the stacked per-site products
+double gemm_peak(int n) {
+  int i, rep;
+  double dtime, best = 1e30;
+  complex *a = malloc(sizeof *a * n * n);
+  complex *b = malloc(sizeof *b * n * n);
+  complex *c = malloc(sizeof *c * n * n);
+
+  if (a == NULL || b == NULL || c == NULL) {
+    printf("gemm_peak: node%d can't malloc workspace\n", this_node);
+    terminate(1);
+  }
+  for (i = 0; i < n * n; i++) {
+    a[i] = cmplx(1.0 / (1.0 + i % 7), 0.5);
+    b[i] = cmplx(0.5, -1.0 / (1.0 + i % 5));
+    c[i] = cmplx(0.0, 0.0);
+  }
+  gemm_rm('N', 'N', n, n, n, a, n, b, n, 0.0, c, n);   // Warm up
+  for (rep = 0; rep < 5; rep++) {
+    dtime = -dclock();
+    gemm_rm('N', 'N', n, n, n, a, n, b, n, 0.0, c, n);
+    dtime += dclock();
+    if (dtime < best)
+      best = dtime;
+  }
+
+  free(a);
+  free(b);
+  free(c);
+  return 8.0 * n * n * n / best * 1e-9;
+}
+#endif
+// -----------------------------------------------------------------
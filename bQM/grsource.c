@@ -11,23 +11,108 @@
 void ranmom() {
   register int i, j;
   register site *s;
-  anti_hermitmat tah;
 
+  TIC(T_RANMOM)
+#ifdef STATIC_GAUGE
+  ranmom_theta();     // Gauge momenta are just those of the phases
+#endif
   FORALLSITES(i, s) {
+#ifndef STATIC_GAUGE
 #ifdef SITERAND
     random_anti_hermitian(&(s->mom), &(s->site_prn));
 #else
-    random_anti_hermitian(&(s->mom), &(s->node_prn));
+    random_anti_hermitian(&(s->mom), &node_prn);
+#endif
+#endif
+
+    for (j = 0; j < nscalar; j++) {
+#ifdef FIXED_SCALARS
+      // The scalars are updated between trajectories, fixed in the MD
+      memset(&(s->mom_X[j]), 0, sizeof(anti_hermitmat));
+#elif defined(SITERAND)
+      random_anti_hermitian(&(s->mom_X[j]), &(s->site_prn));
+#else
+      random_anti_hermitian(&(s->mom_X[j]), &node_prn);
 #endif
+    }
+  }
+  TOC(T_RANMOM, sites_on_node * (1.0 + nscalar) * NADJ * 20.0,
+      sites_on_node * (1.0 + nscalar) * AH_BYTES)
+}
+// -----------------------------------------------------------------
 
-    for (j = 0; j < NSCALAR; j++) {
+
+
+// -----------------------------------------------------------------
+// Generalized HMC, compiled with GHMC
+// The momenta persist between trajectories and are only partially
+// refreshed, p <-- cos(ghmc_angle) p + sin(ghmc_angle) eta, with eta
+// drawn as in ranmom(); ghmc_angle = pi / 2 is standard HMC
+// A rejected trajectory restores the starting momenta with their sign
+// flipped (see flip_mom()), which keeps detailed balance
+// The first call does a full refresh since there are no momenta yet
+#ifdef GHMC
+#ifdef STATIC_GAUGE
+#error "GHMC does not mix the STATIC_GAUGE phase momenta"
+#endif
+void partial_ranmom() {
+  register int i, j;
+  register site *s;
+  static int first = 1;
+  Real c = cos(ghmc_angle), sn = sin(ghmc_angle);
+  anti_hermitmat eta;
+
+  if (first) {
+    first = 0;
+    ranmom();
+  }
+  else {
+    // Scale by cos, then add sin eta
+    TIC(T_RANMOM)
+    FORALLSITES(i, s) {
 #ifdef SITERAND
-      random_anti_hermitian(&tah, &(s->site_prn));
+      random_anti_hermitian(&eta, &(s->site_prn));
 #else
-      random_anti_hermitian(&tah, &(s->node_prn));
+      random_anti_hermitian(&eta, &node_prn);
 #endif
-      uncompress_anti_hermitian(&tah, &(s->mom_X[j]));
+      scalar_mult_ahmat(&(s->mom), c, &(s->mom));
+      scalar_mult_sum_ahmat(&eta, sn, &(s->mom));
+      for (j = 0; j < nscalar; j++) {
+#ifdef FIXED_SCALARS
+        memset(&(s->mom_X[j]), 0, sizeof(anti_hermitmat));
+#else
+#ifdef SITERAND
+        random_anti_hermitian(&eta, &(s->site_prn));
+#else
+        random_anti_hermitian(&eta, &node_prn);
+#endif
+        scalar_mult_ahmat(&(s->mom_X[j]), c, &(s->mom_X[j]));
+        scalar_mult_sum_ahmat(&eta, sn, &(s->mom_X[j]));
+#endif
+      }
     }
+    TOC(T_RANMOM, sites_on_node * (1.0 + nscalar) * NADJ * 24.0,
+        sites_on_node * (1.0 + nscalar) * 2.0 * AH_BYTES)
+  }
+
+  // Save the starting momenta for flip_mom()
+  FORALLSITES(i, s) {
+    s->old_mom = s->mom;
+    for (j = 0; j < nscalar; j++)
+      s->old_mom_X[j] = s->mom_X[j];
   }
 }
+
+// After a rejection, go back to the negated starting momenta
+void flip_mom() {
+  register int i, j;
+  register site *s;
+
+  FORALLSITES(i, s) {
+    scalar_mult_ahmat(&(s->old_mom), -1.0, &(s->mom));
+    for (j = 0; j < nscalar; j++)
+      scalar_mult_ahmat(&(s->old_mom_X[j]), -1.0, &(s->mom_X[j]));
+  }
+}
+#endif
 // -----------------------------------------------------------------
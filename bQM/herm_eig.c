@@ -0,0 +1,263 @@
+// -----------------------------------------------------------------
+// Eigenvalues of a batch of hermitian NCOLxNCOL matrices,
+// returned in ascending order for each matrix
+// NCOL = 2 and 3 use closed forms, and NCOL up to JACOBI_MAX_NCOL the
+// cyclic Jacobi method on blocks of JACOBI_BLOCK matrices stored as
+// structures of arrays, so that each rotation (p, q) is applied to the
+// whole block in branch-free loops that vectorize; the block stays in
+// cache for all sweeps
+// Jacobi needs more sweeps as NCOL grows, and for larger NCOL LAPACK is
+// faster, so it is called for each matrix
+// For NCOL_DYN the choice follows NCOL_MAX, which sizes the block
+// The matrices may be overwritten
+#include "bQM_includes.h"
+
+// Relative size of off-diagonal elements left after Jacobi,
+// and the maximum number of sweeps
+#if (PRECISION == 1)
+#define JACOBI_TOL 1.0e-7
+#else
+#define JACOBI_TOL 1.0e-15
+#endif
+#define JACOBI_MAX_SWEEPS 50
+#define JACOBI_BLOCK 16
+#define JACOBI_MAX_NCOL 8
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Sort NCOL eigenvalues into ascending order
+// The closed forms below and LAPACK already return them in order
+#if (NCOL_PP > 3 && NCOL_DIM <= JACOBI_MAX_NCOL)
+static void sort_eigs(double *e) {
+  register int i, j;
+  double td;
+
+  for (i = 1; i < NCOL; i++) {
+    td = e[i];
+    for (j = i; j > 0 && e[j - 1] > td; j--)
+      e[j] = e[j - 1];
+    e[j] = td;
+  }
+}
+#endif
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+#if (NCOL_PP == 2)
+// (a + d) / 2 +/- sqrt[((a - d) / 2)^2 + |b|^2]
+static void eig_closed(matrix *H, double *e) {
+  double mid = 0.5 * (H->e[0][0].real + H->e[1][1].real);
+  double half = 0.5 * (H->e[0][0].real - H->e[1][1].real);
+  double r = sqrt(half * half + cabs_sq(&(H->e[0][1])));
+
+  e[0] = mid - r;
+  e[1] = mid + r;
+}
+#endif
+
+#if (NCOL_PP == 3)
+// Trigonometric solution of the characteristic cubic:
+// with q = Tr[H] / 3 and B = (H - q) / p, where 6 p^2 = Tr[(H - q)^2],
+// the eigenvalues are q + 2 p cos(phi + 2 pi k / 3), cos(3 phi) = det(B) / 2
+static void eig_closed(matrix *H, double *e) {
+  double q, p, p1, d0, d1, d2, r, phi;
+  complex tc;
+
+  q = (H->e[0][0].real + H->e[1][1].real + H->e[2][2].real) / 3.0;
+  p1 = cabs_sq(&(H->e[0][1])) + cabs_sq(&(H->e[0][2]))
+     + cabs_sq(&(H->e[1][2]));
+  d0 = H->e[0][0].real - q;
+  d1 = H->e[1][1].real - q;
+  d2 = H->e[2][2].real - q;
+  p = sqrt((d0 * d0 + d1 * d1 + d2 * d2 + 2.0 * p1) / 6.0);
+  if (p == 0.0) {
+    e[0] = q;
+    e[1] = q;
+    e[2] = q;
+    return;
+  }
+
+  // det(H - q) = d0 d1 d2 + 2 Re[H01 H12 H20]
+  //            - d0 |H12|^2 - d1 |H02|^2 - d2 |H01|^2
+  CMUL(H->e[0][1], H->e[1][2], tc);
+  r = d0 * d1 * d2 + 2.0 * (tc.real * H->e[2][0].real
+                            - tc.imag * H->e[2][0].imag)
+    - d0 * cabs_sq(&(H->e[1][2])) - d1 * cabs_sq(&(H->e[0][2]))
+    - d2 * cabs_sq(&(H->e[0][1]));
+  r /= 2.0 * p * p * p;
+  if (r <= -1.0)
+    phi = PI / 3.0;
+  else if (r >= 1.0)
+    phi = 0.0;
+  else
+    phi = acos(r) / 3.0;
+
+  e[2] = q + 2.0 * p * cos(phi);
+  e[0] = q + 2.0 * p * cos(phi + 2.0 * PI / 3.0);
+  e[1] = 3.0 * q - e[0] - e[2];
+}
+#endif
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+#if (NCOL_PP > 3 && NCOL_DIM <= JACOBI_MAX_NCOL)
+// A block of the batch in structure-of-arrays form, element [a][b] of
+// matrix l being (re[a][b][l], im[a][b][l]), so that the loops over l
+// below have no branches and vectorize
+// Only the upper triangle a <= b is kept up to date, each element below
+// the diagonal being the conjugate of its mirror; this way every element
+// is written once per rotation, which keeps the aliasing simple enough
+// for the compiler
+typedef struct {
+  double re[NCOL_DIM][NCOL_DIM][JACOBI_BLOCK];
+  double im[NCOL_DIM][NCOL_DIM][JACOBI_BLOCK];
+} jacobi_block;
+
+// Jacobi rotation zeroing element (p, q) of every matrix in the block
+// where it is not already negligible, returning the number rotated
+// With H[p][q] = r e^{i phi}, the unitary J = diag(1, e^{-i phi}) R
+// in the (p, q) plane, with R the real rotation of the symmetric case,
+// gives Jdag H J with
+//   H'[k][p] = c H[k][p] - s e^{-i phi} H[k][q]
+//   H'[k][q] = s H[k][p] + c e^{-i phi} H[k][q]
+//   H'[p][p] = H[p][p] - t r,  H'[q][q] = H[q][q] + t r
+// where the (k, p) and (k, q) elements are read from and written to
+// the upper triangle with sign sp and sq on their imaginary parts
+// Matrices with negligible H[p][q] get c = 1, s = t = 0 and no phase,
+// which leaves them unchanged
+static int jacobi_rotate(jacobi_block *B, int p, int q) {
+  register int k, l;
+  int nrot = 0;
+  double app, aqq, xr, xi, r2, r, tau, t, on;
+  double c[JACOBI_BLOCK], s[JACOBI_BLOCK], tr[JACOBI_BLOCK];
+  double phr[JACOBI_BLOCK], phi[JACOBI_BLOCK], off[JACOBI_BLOCK];
+  double hpr, hpi, hqr, hqi, sp, sq;
+  int kp, pk, kq, qk;
+
+  for (l = 0; l < JACOBI_BLOCK; l++) {
+    app = B->re[p][p][l];
+    aqq = B->re[q][q][l];
+    xr = B->re[p][q][l];
+    xi = B->im[p][q][l];
+    r2 = xr * xr + xi * xi;
+    on = (r2 > JACOBI_TOL * JACOBI_TOL * (app * app + aqq * aqq) ? 1.0 : 0.0);
+    off[l] = 1.0 - on;
+    r = sqrt(on * r2 + off[l]);
+    tau = 0.5 * (aqq - app) / r;
+    t = on * copysign(1.0, tau) / (fabs(tau) + sqrt(1.0 + tau * tau));
+    c[l] = 1.0 / sqrt(1.0 + t * t);
+    s[l] = t * c[l];
+    tr[l] = t * r;
+    phr[l] = on * xr / r + off[l];            // e^{-i phi}
+    phi[l] = -on * xi / r;
+    nrot += (int)on;
+  }
+
+  for (k = 0; k < NCOL; k++) {
+    if (k == p || k == q)
+      continue;
+    kp = (k < p ? k : p);
+    pk = (k < p ? p : k);
+    kq = (k < q ? k : q);
+    qk = (k < q ? q : k);
+    sp = (k < p ? 1.0 : -1.0);
+    sq = (k < q ? 1.0 : -1.0);
+    for (l = 0; l < JACOBI_BLOCK; l++) {
+      hpr = B->re[kp][pk][l];
+      hpi = sp * B->im[kp][pk][l];
+      hqr = phr[l] * B->re[kq][qk][l] - sq * phi[l] * B->im[kq][qk][l];
+      hqi = sq * phr[l] * B->im[kq][qk][l] + phi[l] * B->re[kq][qk][l];
+      B->re[kp][pk][l] = c[l] * hpr - s[l] * hqr;
+      B->im[kp][pk][l] = sp * (c[l] * hpi - s[l] * hqi);
+      B->re[kq][qk][l] = s[l] * hpr + c[l] * hqr;
+      B->im[kq][qk][l] = sq * (s[l] * hpi + c[l] * hqi);
+    }
+  }
+  for (l = 0; l < JACOBI_BLOCK; l++) {
+    B->re[p][p][l] -= tr[l];
+    B->re[q][q][l] += tr[l];
+    B->re[p][q][l] *= off[l];
+    B->im[p][q][l] *= off[l];
+  }
+  return nrot;
+}
+#endif
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Eigenvalues of the n matrices H[0..n-1], NCOL each in eigs
+// For Jacobi a last partial block is padded with zero matrices,
+// which need no rotations
+void herm_eig_batch(matrix *H, int n, double *eigs) {
+#if (NCOL_PP > 3 && NCOL_DIM <= JACOBI_MAX_NCOL)
+  register int a, b, l;
+  int k0, nk, sweep, rotated;
+  static jacobi_block B;
+
+  for (k0 = 0; k0 < n; k0 += JACOBI_BLOCK) {
+    nk = (k0 + JACOBI_BLOCK < n ? JACOBI_BLOCK : n - k0);
+    for (a = 0; a < NCOL; a++) {
+      for (b = a; b < NCOL; b++) {
+        for (l = 0; l < nk; l++) {
+          B.re[a][b][l] = H[k0 + l].e[a][b].real;
+          B.im[a][b][l] = H[k0 + l].e[a][b].imag;
+        }
+        for (l = nk; l < JACOBI_BLOCK; l++) {
+          B.re[a][b][l] = 0.0;
+          B.im[a][b][l] = 0.0;
+        }
+      }
+    }
+
+    rotated = 1;
+    for (sweep = 0; rotated && sweep < JACOBI_MAX_SWEEPS; sweep++) {
+      rotated = 0;
+      for (a = 0; a < NCOL; a++) {
+        for (b = a + 1; b < NCOL; b++)
+          rotated += jacobi_rotate(&B, a, b);
+      }
+    }
+    if (rotated)
+      printf("herm_eig_batch: no convergence after %d sweeps\n", sweep);
+
+    for (l = 0; l < nk; l++) {
+      for (a = 0; a < NCOL; a++)
+        eigs[(k0 + l) * NCOL + a] = B.re[a][a][l];
+      sort_eigs(eigs + (k0 + l) * NCOL);
+    }
+  }
+#elif (NCOL_PP > 3)
+  register int k, a, b;
+  char N = 'N';     // Ask LAPACK only for eigenvalues
+  char U = 'U';     // Have LAPACK use the upper triangle
+  int Npt = NCOL, stat = 0, Nwork = 2 * NCOL;
+
+  for (k = 0; k < n; k++) {
+    // Convert to column-major double array used by LAPACK
+    for (a = 0; a < NCOL; a++) {
+      for (b = a; b < NCOL; b++) {
+        store[2 * (b * NCOL + a)] = H[k].e[a][b].real;
+        store[2 * (b * NCOL + a) + 1] = H[k].e[a][b].imag;
+      }
+    }
+    zheev_(&N, &U, &Npt, store, &Npt, eigs + k * NCOL, work, &Nwork,
+           Rwork, &stat);
+    if (stat != 0)
+      printf("herm_eig_batch: zheev_ returned %d\n", stat);
+  }
+#else
+  register int k;
+
+  for (k = 0; k < n; k++)
+    eig_closed(&(H[k]), eigs + k * NCOL);
+#endif
+}
+// -----------------------------------------------------------------
@@ -0,0 +1,92 @@
+// -----------------------------------------------------------------
+// Histograms of the scalar eigenvalues and the Polyakov loop eigenphases,
+// HIST_BINS bins for each of the NCOL ordered eigenvalues
+// Scalar eigenvalues are binned in [-hist_eig_max, hist_eig_max] and
+// phases relative to their circular mean in [-pi, pi], with one extra
+// bin at each end for values outside the range
+// Each node counts its own sites, and hist_write() merges the counts
+// with a single g_vecdoublesum, adds them to the totals on node0 and
+// rewrites hist_file, so that it always holds a complete histogram
+// Binary format, in the native byte order:
+//   int    HIST_VERSION, NCOL, HIST_BINS, nscalar
+//   double hist_eig_max, pi
+//   double scalar counts[NCOL][HIST_BINS + 2]
+//   double phase counts[NCOL][HIST_BINS + 2]
+// where bin b in 1..HIST_BINS covers [lo + (b - 1) w, lo + b w)
+// Nothing is counted unless hist_eig_max > 0
+#include "bQM_includes.h"
+
+#define HIST_VERSION 1
+#define HIST_ROW (HIST_BINS + 2)
+#define HIST_SIZE (2 * NCOL * HIST_ROW)
+#define HIST_DIM (2 * NCOL_DIM * HIST_ROW)
+
+// Counts since the last merge on each node, and totals on node0
+static double hcount[HIST_DIM], htotal[HIST_DIM];
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Count NCOL ordered values in [-range, range], in the histograms
+// starting at h
+static void hist_fill(double *h, double *x, double range) {
+  register int k;
+  int b;
+  double scale = 0.5 * HIST_BINS / range;
+
+  for (k = 0; k < NCOL; k++) {
+    b = (int)floor((x[k] + range) * scale) + 1;
+    if (b < 0)
+      b = 0;
+    else if (b > HIST_BINS + 1)
+      b = HIST_BINS + 1;
+    h[k * HIST_ROW + b] += 1.0;
+  }
+}
+
+// Eigenvalues of one scalar on one site, in ascending order
+void hist_scalar(double *eigs) {
+  if (hist_eig_max > 0.0)
+    hist_fill(hcount, eigs, hist_eig_max);
+}
+
+// Sorted Polyakov loop phases, from the node that computes them
+void hist_phases(double *phases) {
+  if (hist_eig_max > 0.0)
+    hist_fill(hcount + NCOL * HIST_ROW, phases, PI);
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Merge the counts from all nodes and rewrite hist_file
+void hist_write() {
+  register int j;
+  int header[4] = {HIST_VERSION, NCOL, HIST_BINS, nscalar};
+  double range[2] = {hist_eig_max, PI};
+  FILE *fp;
+
+  if (hist_eig_max <= 0.0)
+    return;
+  g_vecdoublesum(hcount, HIST_SIZE);
+  for (j = 0; j < HIST_SIZE; j++) {
+    htotal[j] += hcount[j];
+    hcount[j] = 0.0;
+  }
+
+  if (this_node != 0)
+    return;
+  fp = fopen(hist_file, "wb");
+  if (fp == NULL) {
+    printf("hist_write: can't open %s\n", hist_file);
+    return;
+  }
+  if (fwrite(header, sizeof(int), 4, fp) != 4
+      || fwrite(range, sizeof(double), 2, fp) != 2
+      || fwrite(htotal, sizeof(double), HIST_SIZE, fp) != HIST_SIZE)
+    printf("hist_write: error writing %s\n", hist_file);
+  fclose(fp);
+}
+// -----------------------------------------------------------------
@@ -0,0 +1,206 @@
+// -----------------------------------------------------------------
+// Holonomy-only sampler, compiled with HOLONOMY_ONLY (and STATIC_GAUGE)
+// The action is gaussian in the scalars, so they can be integrated out
+// exactly in the static diagonal gauge of static_gauge.c
+// With cosh(mu) = 1 + omega^2 / 2 every adjoint mode (a, b) of every
+// scalar is a periodic chain twisted by the phase difference
+// theta_ab = theta_a - theta_b, with determinant
+//   prod_k [2 cosh(mu) - 2 cos((2 pi k + theta_ab) / nt)]
+//     = 2 [cosh(nt mu) - cos(theta_ab)]
+// The NCOL - 1 diagonal modes are untwisted, so only the off-diagonal
+// complex modes depend on the phases, leaving the effective action
+//   S_eff = sum_{a<b} {nscalar log[cosh(nt mu) - cos(theta_ab)]
+//                      - log sin^2(theta_ab / 2)}
+// which is sampled here by HMC for the phases alone
+//
+// The scalar observables are the exact expectation values given the
+// phases, using the twisted propagator at zero separation
+//   G(alpha) = (1 / nt) sum_k 1 / [2 cosh(mu) - 2 cos((2 pi k + alpha) / nt)]
+//            = sinh(nt mu) / {2 sinh(mu) [cosh(nt mu) - cos(alpha)]}
+// With q = exp(-nt mu) everything is written in terms of
+//   1 + q^2 - 2 q cos(alpha) = 2 q [cosh(nt mu) - cos(alpha)]
+// to avoid overflow for large nt
+#include "bQM_includes.h"
+
+#ifdef HOLONOMY_ONLY
+static double q = -1.0, sinh_mu;
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Set q and sinh(mu) on first use
+static void setup_holonomy() {
+  double mu;
+
+  if (omega <= 0.0) {
+    node0_printf("ERROR: HOLONOMY_ONLY needs omega > 0 ");
+    node0_printf("to integrate out the constant scalar modes\n");
+    terminate(1);
+  }
+  mu = acosh(1.0 + 0.5 * omega * omega);
+  q = exp(-nt * mu);
+  sinh_mu = sinh(mu);
+}
+
+// 2 q [cosh(nt mu) - cos(alpha)]
+static double twist_det(double alpha) {
+  return 1.0 + q * q - 2.0 * q * cos(alpha);
+}
+
+// Twisted propagator G(alpha)
+static double twist_prop(double alpha) {
+  return (1.0 - q * q) / (2.0 * sinh_mu * twist_det(alpha));
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Effective action of the phases plus their kinetic term,
+// dropping constants
+double holonomy_action() {
+  register int a, b;
+  double sum = 0.0;
+
+  if (q < 0.0)
+    setup_holonomy();
+  for (a = 0; a < NCOL; a++) {
+    for (b = a + 1; b < NCOL; b++)
+      sum += nscalar * log(twist_det(theta[a] - theta[b]));
+  }
+  return sum + vandermonde_action() + theta_mom_action();
+}
+
+// Update theta_mom with the force
+//   dS_eff / dtheta_c = sum_{b != c} {nscalar 2 q sin(theta_cb) / D(theta_cb)
+//                                     - cot(theta_cb / 2)}
+// with D = twist_det, and return its magnitude
+double holonomy_force(Real eps) {
+  register int a, b;
+  double force[NCOL], th, returnit = 0.0;
+
+  for (a = 0; a < NCOL; a++) {
+    force[a] = 0.0;
+    for (b = 0; b < NCOL; b++) {
+      if (b == a)
+        continue;
+      th = theta[a] - theta[b];
+      force[a] += 2.0 * nscalar * q * sin(th) / twist_det(th);
+      force[a] -= 1.0 / tan(0.5 * th);
+    }
+  }
+  for (a = 0; a < NCOL; a++) {
+    theta_mom[a] -= eps * force[a];
+    returnit += force[a] * force[a];
+  }
+  traceless_theta(theta_mom);
+  return eps * sqrt(returnit);
+}
+
+static void update_theta(Real eps) {
+  register int a;
+
+  for (a = 0; a < NCOL; a++)
+    theta[a] += eps * theta_mom[a];
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// One leapfrog trajectory for the phases with accept/reject,
+// printing the same lines as update() in update_leapfrog.c
+// Every node does the same work, with the random numbers from node 0
+void holonomy_update() {
+  int step;
+  Real eps = traj_length / (Real)nsteps, xrandom;
+  double startaction, endaction, change, tr;
+
+  ranmom_theta();
+  startaction = holonomy_action();
+  bnorm = 0.0;
+  max_bf = 0.0;
+  begin_proposal();
+
+  update_theta(0.5 * eps);
+  for (step = 0; step < nsteps; step++) {
+    tr = holonomy_force(eps);
+    bnorm += tr;
+    if (tr > max_bf)
+      max_bf = tr;
+    if (step < nsteps - 1)
+      update_theta(eps);
+    else
+      update_theta(0.5 * eps);
+  }
+
+  endaction = holonomy_action();
+  change = endaction - startaction;
+  // Also catches NaN from coincident phases
+  if (!(fabs(change) < 1e20)) {
+    node0_printf("WARNING: Correcting Apparent Overflow: Delta S = %.4g\n",
+                 change);
+    change = 1.0e20;
+  }
+
+  if (this_node == 0)
+    xrandom = myrand(&node_prn);
+  broadcast_float(&xrandom);
+  if (exp(-change) < (double)xrandom) {
+    end_proposal(0);
+    node0_printf("REJECT: delta S = %.4g start S = %.12g end S = %.12g\n",
+                 change, startaction, endaction);
+  }
+  else {
+    end_proposal(1);
+    node0_printf("ACCEPT: delta S = %.4g start S = %.12g end S = %.12g\n",
+                 change, startaction, endaction);
+  }
+  if (traj_length > 0) {
+    node0_printf("MONITOR_FORCE %.4g %.4g\n",
+                 bnorm / (double)nsteps, max_bf);
+  }
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Exact conditional expectation of the scalar_trace() observables
+// In the basis of scalar_gibbs.c each real mode of each scalar has
+// <x^2> = G(alpha) / (2 beta), with alpha = 0 for the NCOL - 1 diagonal
+// modes and theta_ab for both real components of each pair a < b
+// Tr[X^dag X] / N at one site is a sum of these squares, so its mean
+// is their sum / N and its width is sqrt(2 sum <x^2>^2) / N
+// The same for every scalar
+double holonomy_scalar_trace(double *Xtr, double *Xwidth) {
+  register int a, b, j;
+  double v, mean, var;
+
+  if (q < 0.0)
+    setup_holonomy();
+  v = twist_prop(0.0) / (2.0 * beta);
+  mean = (NCOL - 1.0) * v;
+  var = (NCOL - 1.0) * v * v;
+  for (a = 0; a < NCOL; a++) {
+    for (b = a + 1; b < NCOL; b++) {
+      v = twist_prop(theta[a] - theta[b]) / (2.0 * beta);
+      mean += 2.0 * v;
+      var += 2.0 * v * v;
+    }
+  }
+  mean *= one_ov_N;
+  *Xwidth = sqrt(2.0 * var) * one_ov_N;
+  for (j = 0; j < nscalar; j++)
+    Xtr[j] = mean;
+  return mean;
+}
+
+// Exact expectation of bosonic_action() / nt: each of the NADJ nscalar
+// real modes per time slice contributes 1/2, whatever the phases
+double holonomy_b_act() {
+  return 0.5 * NADJ * nscalar;
+}
+#endif
+// -----------------------------------------------------------------
@@ -25,18 +25,18 @@ typedef struct {
   double_prn site_prn;
 #endif
 
-  matrix link;          // Gauge link (in group)
-  matrix X[NSCALAR];    // Scalars (in algebra)
-
-#ifdef HMC_ALGORITHM
-  matrix old_link, old_X[NSCALAR];      // For accept/reject
+  // The gauge links and scalars are fields rather than site members,
+  // double-buffered for accept/reject (see below)
+
+  // All momenta are compressed anti-hermitian matrices,
+  // like the scalars themselves
+  // The scalar force goes straight into mom_X, see bosonic_force()
+  anti_hermitmat mom, mom_X[NSCALAR];
+  matrix f_U;
+#ifdef GHMC
+  // Momenta at the start of the trajectory, restored (negated) on reject
+  anti_hermitmat old_mom, old_mom_X[NSCALAR];
 #endif
-
-  // All momenta should be anti-hermitian matrices
-  // Since scalars are anti-hermitian but stored as full matrices,
-  // simplest to treat their momenta the same way
-  anti_hermitmat mom;
-  matrix f_U, mom_X[NSCALAR], f_X[NSCALAR];
 } site;
 // -----------------------------------------------------------------
 
@@ -51,12 +51,23 @@ typedef struct {
 #endif
 
 EXTERN int nt;              // Lattice length
+EXTERN int nscalar;         // Number of scalars, at most NSCALAR
+#ifdef NCOL_DYN
+EXTERN int ncol_dyn;        // NCOL, from the input, see ../include/bQM.h
+#endif
 EXTERN int iseed;           // Random number seed
 EXTERN int warms, trajecs, propinterval;
+EXTERN int therm_detect;         // If nonzero, warms is only the maximum
+EXTERN int meas_every[N_MEAS];   // Trajectories between measurements
+EXTERN Real stop_rel_err;        // Stop once measure_converged(), if > 0
+EXTERN Real meas_tau_factor;     // See measure_adjust(), fixed if zero
+EXTERN Real hist_eig_max;        // Range of scalar eigenvalue histograms
+EXTERN char hist_file[MAXFILENAME];
+EXTERN char obs_file[MAXFILENAME];   // "none" for no observable stream
 EXTERN Real traj_length;
 
 // SU(N) generators
-EXTERN matrix Lambda[NADJ];
+EXTERN matrix Lambda[NADJ_DIM];
 EXTERN Real beta, omega;
 EXTERN double_complex linktrsum;
 EXTERN u_int32type nersc_checksum;
@@ -84,8 +95,48 @@ EXTERN double_prn node_prn;
 // For convenience in calculating action and force
 EXTERN Real one_ov_N;
 
+// Gauge links (in group) and scalars (in algebra)
+// The scalars are stored as compressed anti-hermitian matrices
+// The accepted configuration is in link_buf[cur_buf] and X_buf[cur_buf]
+// links and X point to the active buffer act_buf, which is the other one
+// during the molecular dynamics, so accept/reject just decides which
+// buffer becomes current
+// (see begin_proposal() and end_proposal() in library_util.c)
+// Only one buffer is allocated without HMC_ALGORITHM
+EXTERN matrix *link_buf[2], *links;
+EXTERN anti_hermitmat *X_buf[2][NSCALAR], *X[NSCALAR];
+EXTERN int cur_buf, act_buf, prop_pending;
+
+#ifdef SCALAR_HEATBATH
+EXTERN int nover;   // Overrelaxation sweeps per scalar heatbath sweep
+#endif
+
+#ifdef GHMC
+EXTERN Real ghmc_angle;     // Momentum mixing angle, pi / 2 for HMC
+#endif
+
+#ifdef LINK_METROPOLIS
+EXTERN int link_sweeps;     // SU(2) subgroup sweeps per trajectory
+EXTERN Real link_step;      // Width of the SU(2) proposals
+#endif
+
+#ifdef PLOOP_BIAS
+// Umbrella and metadynamics bias on |Tr L| / N, see bias.c
+EXTERN Real bias_kappa, bias_q0;
+EXTERN Real bias_height, bias_width, bias_dT;
+EXTERN int bias_stride;
+#endif
+
+#ifdef STATIC_GAUGE
+// Polyakov loop eigenphases, their momenta, and the phases at the start
+// of the current proposal; every link is diag(exp(i theta / nt)),
+// see static_gauge.c
+EXTERN Real theta[NCOL_DIM], theta_mom[NCOL_DIM], old_theta[NCOL_DIM];
+#endif
+
 // Temporary matrices
-EXTERN matrix *tempmat, *tempmat2, *temp_X[NSCALAR];
+EXTERN matrix *tempmat, *tempmat2;
+EXTERN anti_hermitmat *temp_X[NSCALAR];
 
 // Allocate some more arrays to be used by LAPACK in scalar eigenvalues
 // and reunitarization (in generic directory)
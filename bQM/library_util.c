@@ -6,32 +6,68 @@
 
 
 // -----------------------------------------------------------------
-// Copy the gauge field and scalars on all sites
-#ifdef HMC_ALGORITHM
-void copy_bosons(int sign) {
-  register int i, j;
-  register site *s;
+// Point links and X at the given buffer
+void set_active_fields(int buf) {
+  register int j;
 
-  if (sign == 1) {
-    FORALLSITES(i, s) {
-      mat_copy(&(s->link), &(s->old_link));
-      for (j = 0; j < NSCALAR; j++)
-        mat_copy(&(s->X[j]), &(s->old_X[j]));
-    }
-  }
-  else if (sign == -1) {
-    FORALLSITES(i, s) {
-      mat_copy(&(s->old_link), &(s->link));
-      for (j = 0; j < NSCALAR; j++)
-        mat_copy(&(s->old_X[j]), &(s->X[j]));
-    }
+  act_buf = buf;
+  links = link_buf[buf];
+  for (j = 0; j < nscalar; j++)
+    X[j] = X_buf[buf][j];
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Accept/reject without copying the gauge field and scalars
+// begin_proposal() marks the start of a trajectory, after which the
+// first update_u() reads the current buffer and writes the other one
+// end_proposal() then either keeps the proposal buffer as current,
+// or just points the fields back at the unchanged current buffer
+#ifdef HMC_ALGORITHM
+void begin_proposal() {
+  if (act_buf != cur_buf) {
+    node0_printf("Error: begin_proposal with proposal still active\n");
+    terminate(1);
   }
+  prop_pending = 1;
+#ifdef STATIC_GAUGE
+  int a;
+  for (a = 0; a < NCOL; a++)
+    old_theta[a] = theta[a];
+#endif
+}
+
+void end_proposal(int accept) {
+  prop_pending = 0;
+  if (accept)
+    cur_buf = act_buf;
   else {
-    node0_printf("Error: incorrect sign in copy_boson: %d\n", sign);
-    terminate(1);
+    set_active_fields(cur_buf);
+#ifdef STATIC_GAUGE
+    int a;
+    for (a = 0; a < NCOL; a++)
+      theta[a] = old_theta[a];
+#endif
   }
 }
 #endif
+
+// Buffer into which update_u() should write the updated fields
+// Only differs from the active buffer for the first update of a proposal
+int update_target() {
+  if (prop_pending)
+    return 1 - cur_buf;
+  return act_buf;
+}
+
+// Make the buffer written by update_u() active
+void finish_update(int buf) {
+  prop_pending = 0;
+  if (buf != act_buf)
+    set_active_fields(buf);
+}
 // -----------------------------------------------------------------
 
 
@@ -46,7 +82,9 @@ void shiftmat(matrix *dat, matrix *temp, int dir) {
 
   mtag = start_gather_field(dat, sizeof(matrix),
                             dir, EVENANDODD, gen_pt[0]);
+  TIC(T_GATHER)
   wait_gather(mtag);
+  TOC(T_GATHER, 0.0, GATHER_BYTES)
   FORALLSITES(i, s)
     mat_copy((matrix *)gen_pt[0][i], &(temp[i]));
   cleanup_gather(mtag);
@@ -0,0 +1,112 @@
+// -----------------------------------------------------------------
+// Local Metropolis updates of the links in SU(2) subgroups,
+// compiled with LINK_METROPOLIS
+// In one dimension each link U(t) only appears in the hopping term
+//   S_U = 2 beta sum_j Re Tr[X_j(t) U X_j(t+1) Udag]
+// so given the scalars all links are independent and every site
+// can be updated at once, with no need to checkerboard
+// For each SU(2) subgroup (p, q), Cabibbo--Marinari style, we propose
+// U -> h U with h = exp(i a.sigma) embedded in rows p and q, where
+// a is gaussian with width link_step, so that h and hdag are equally
+// likely, and accept with probability exp(-dS)
+// The action is quadratic in U (adjoint representation), so the usual
+// SU(2) overrelaxation reflection is not microcanonical here
+//
+// With V_j = U X_j(t+1) Udag each proposal changes
+//   V_j -> h V_j hdag
+// which only touches rows and columns p and q, through
+// left_su2_hit_n() and right_su2_hit_a()
+#include "bQM_includes.h"
+
+#ifdef LINK_METROPOLIS
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Random SU(2) matrix exp(i a.sigma) with gaussian a of width link_step
+static void random_su2(su2_matrix *h, double_prn *prn_pt) {
+  Real a1, a2, a3, r, sr;
+
+  a1 = link_step * gaussian_rand_no(prn_pt);
+  a2 = link_step * gaussian_rand_no(prn_pt);
+  a3 = link_step * gaussian_rand_no(prn_pt);
+  r = sqrt(a1 * a1 + a2 * a2 + a3 * a3);
+  sr = (r > 0.0 ? sin(r) / r : 1.0);
+  h->e[0][0] = cmplx(cos(r), sr * a3);
+  h->e[0][1] = cmplx(sr * a2, sr * a1);
+  h->e[1][0] = cmplx(-sr * a2, sr * a1);
+  h->e[1][1] = cmplx(cos(r), -sr * a3);
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// link_sweeps Metropolis sweeps over all SU(2) subgroups of every link
+// Prints and returns the acceptance rate
+double link_metropolis() {
+  register int i, j, p, q;
+  register site *s;
+  int sweep;
+  double dS, accept = 0.0, tries;
+  matrix tmat, Xm[NSCALAR], V[NSCALAR], Vnew[NSCALAR];
+  su2_matrix h;
+  msg_tag *tag[NSCALAR];
+
+  if (link_sweeps <= 0)
+    return 0.0;
+
+  TIC(T_LINK_METRO)
+  for (j = 0; j < nscalar; j++) {
+    tag[j] = start_gather_field(X[j], sizeof(anti_hermitmat),
+                               TUP, EVENANDODD, gen_pt[j]);
+  }
+  TIC(T_GATHER)
+  for (j = 0; j < nscalar; j++)
+    wait_gather(tag[j]);
+  TOC(T_GATHER, 0.0, nscalar * GATHER_AH_BYTES)
+
+  FORALLSITES(i, s) {
+    for (j = 0; j < nscalar; j++) {
+      uncompress_anti_hermitian(&(X[j][i]), &(Xm[j]));
+      uncompress_anti_hermitian((anti_hermitmat *)(gen_pt[j][i]), &tmat);
+      mult_na(&tmat, &(links[i]), &(Vnew[j]));
+      mult_nn(&(links[i]), &(Vnew[j]), &(V[j]));
+    }
+
+    for (sweep = 0; sweep < link_sweeps; sweep++) {
+      for (p = 0; p < NCOL; p++) {
+        for (q = p + 1; q < NCOL; q++) {
+          random_su2(&h, &(s->site_prn));
+          dS = 0.0;
+          for (j = 0; j < nscalar; j++) {
+            mat_copy(&(V[j]), &(Vnew[j]));
+            left_su2_hit_n(&h, p, q, &(Vnew[j]));
+            right_su2_hit_a(&h, p, q, &(Vnew[j]));
+            dS += d_realtrace_nn(&(Xm[j]), &(Vnew[j]))
+                - d_realtrace_nn(&(Xm[j]), &(V[j]));
+          }
+          dS *= 2.0 * beta;
+          if (dS <= 0.0 || exp(-dS) > myrand(&(s->site_prn))) {
+            left_su2_hit_n(&h, p, q, &(links[i]));
+            for (j = 0; j < nscalar; j++)
+              mat_copy(&(Vnew[j]), &(V[j]));
+            accept++;
+          }
+        }
+      }
+    }
+  }
+  for (j = 0; j < nscalar; j++)
+    cleanup_gather(tag[j]);
+
+  g_doublesum(&accept);
+  tries = (double)link_sweeps * nt * NCOL * (NCOL - 1) / 2;
+  node0_printf("LINK_METRO accept %.4g\n", accept / tries);
+  TOC(T_LINK_METRO, link_sweeps * sites_on_node * LINK_METRO_FLOPS,
+      sites_on_node * LINK_METRO_BYTES)
+  return accept / tries;
+}
+#endif
+// -----------------------------------------------------------------
@@ -0,0 +1,385 @@
+// -----------------------------------------------------------------
+// Measurements scheduled from the input file
+// Each observable is declared with its own interval, so cheap ones can
+// run every trajectory and expensive ones every few, for example
+//   meas_scalar_trace 1
+//   meas_action 1
+//   meas_ploop 1
+//   meas_scalar_eig 10
+//   meas_corr 10
+// with zero switching an observable off
+// The observables that are sums over sites (scalar squares, bosonic
+// action and scalar eigenvalues) share one sweep over the lattice,
+// after a single round of gathers, and their node sums are combined into
+// one g_vecdoublesum and one g_vecdoublemax
+// The Polyakov loop needs its own shifts along the line, and the
+// correlators collect the whole line (corr.c)
+// The output lines are the same as those printed by control.c before
+// Every measurement of the scalar observables below also goes into
+// streaming statistics and autocorrelations (stats.c), reported by
+// measure_report()
+// With meas_tau_factor > 0, measure_adjust() sets the spacing of the
+// expensive measurements from the integrated autocorrelation times
+// During the warmups, measure_thermalized() watches b_act/nt, Xtr_ave
+// and |P| for drift
+#include "bQM_includes.h"
+
+// Input tags, in the order of enum meas_id in defines.h
+char *meas_tag[N_MEAS] = {"meas_scalar_trace", "meas_action",
+                          "meas_ploop", "meas_scalar_eig", "meas_corr"};
+
+// Size of the packed sums and maxima
+#define MEAS_NSUM (NSCALAR + 3 + 2 * NCOL)
+#define MEAS_NMAX (2 * NCOL)
+
+// Observables with streaming statistics, each tied to the measurement
+// that provides it
+// Re(P) averages to zero, so it is not used to judge convergence
+enum stat_id { S_XTR, S_BACT, S_REP, S_ABSP, S_EIG, N_STAT };
+static char *stat_name[N_STAT] = {"Xtr_ave", "b_act/nt", "ReP", "|P|",
+                                  "max_eig"};
+static int stat_meas[N_STAT] = {M_SCALAR_TRACE, M_ACTION, M_PLOOP,
+                                M_PLOOP, M_SCALAR_EIG};
+static stat_t stats[N_STAT];
+static acorr_t acorrs[N_STAT];
+static int stats_ready = 0;
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// One sweep for the observables in todo that are sums over sites
+// The packed sums are
+//   Xtr[nscalar], XtrSq, sqterms, hopterms, eigenvalues, their squares
+// and the packed maxima are the largest and minus the smallest eigenvalues
+static void site_sweep(int todo, meas_t *m) {
+  register int i, j;
+  register site *s;
+  int do_tr = todo & MEAS_BIT(M_SCALAR_TRACE);
+  int do_act = todo & MEAS_BIT(M_ACTION);
+  int do_eig = todo & MEAS_BIT(M_SCALAR_EIG);
+  double sum[MEAS_NSUM], ext[MEAS_NMAX], td, norm;
+  double *XtrSq = sum + nscalar, *sqterms = XtrSq + 1, *hopterms = XtrSq + 2;
+  double *eig_sum = XtrSq + 3, *eig_sq = eig_sum + NCOL;
+  double c_sq = 0.0, c_hop = 0.0, min_eigs[NCOL];
+  matrix tX, tX1;
+  msg_tag *tag[NSCALAR];
+
+  TIC(T_MEASURE)
+  for (j = 0; j < MEAS_NSUM; j++)
+    sum[j] = 0.0;
+  for (j = 0; j < NCOL; j++) {
+    ext[j] = -99.0;
+    min_eigs[j] = 99.0;
+  }
+
+  // Only the action needs the neighbouring scalars
+  if (do_act) {
+    for (j = 0; j < nscalar; j++) {
+      tag[j] = start_gather_field(X[j], sizeof(anti_hermitmat),
+                                 TUP, EVENANDODD, gen_pt[j]);
+    }
+    TIC(T_GATHER)
+    for (j = 0; j < nscalar; j++)
+      wait_gather(tag[j]);
+    TOC(T_GATHER, 0.0, nscalar * GATHER_AH_BYTES)
+  }
+
+  // Accumulate with compensated summation for the action,
+  // as in bosonic_action()
+  FORALLSITES(i, s) {
+    for (j = 0; j < nscalar && (do_tr || do_act); j++) {
+      td = realtrace_ahmat(&(X[j][i]), &(X[j][i]));
+      if (do_tr) {
+        sum[j] += td;
+        *XtrSq += td * td;
+      }
+      if (do_act) {
+        kahan_sum(sqterms, &c_sq, td);
+        uncompress_anti_hermitian(&(X[j][i]), &tX);
+        uncompress_anti_hermitian((anti_hermitmat *)(gen_pt[j][i]), &tX1);
+        kahan_sum(hopterms, &c_hop, site_hop_trace(&tX, &(links[i]), &tX1));
+      }
+    }
+    if (do_eig)
+      scalar_eig_load(i);
+  }
+  if (do_act) {
+    for (j = 0; j < nscalar; j++)
+      cleanup_gather(tag[j]);
+  }
+  if (do_eig)
+    scalar_eig_local(eig_sum, eig_sq, min_eigs, ext);
+  TOC(T_MEASURE, do_act ? sites_on_node * MEASURE_FLOPS : 0.0,
+      sites_on_node * MEASURE_BYTES)
+
+  TIC(T_REDUCE)
+  g_vecdoublesum(sum, nscalar + 3 + 2 * NCOL);
+  if (do_eig) {
+    for (j = 0; j < NCOL; j++)
+      ext[NCOL + j] = -min_eigs[j];
+    g_vecdoublemax(ext, MEAS_NMAX);
+  }
+  TOC(T_REDUCE, 0.0, (nscalar + 3.0 + 4.0 * NCOL) * REDUCE_BYTES)
+
+  // Finalize as in scalar_trace(), bosonic_action() and scalar_eig()
+  if (do_tr) {
+    m->Xtr_ave = 0.0;
+    for (j = 0; j < nscalar; j++) {
+      m->Xtr[j] = sum[j] * one_ov_N / (double)nt;
+      m->Xtr_ave += m->Xtr[j];
+    }
+    m->Xtr_ave /= (double)nscalar;
+    td = *XtrSq * one_ov_N * one_ov_N / ((double)nt * nscalar);
+    m->Xtr_width = sqrt(td - m->Xtr_ave * m->Xtr_ave);
+  }
+  if (do_act) {
+    m->sqterms = *sqterms;
+    m->hopterms = *hopterms;
+    m->b_act = beta * ((2.0 + omega * omega) * *sqterms + 2.0 * *hopterms);
+    m->bias = 0.0;
+  }
+  if (do_eig) {
+    norm = 1.0 / (double)(nscalar * nt);
+    for (j = 0; j < NCOL; j++) {
+      m->ave_eigs[j] = eig_sum[j] * norm;
+      td = eig_sq[j] * norm;
+      m->eig_widths[j] = sqrt(td - m->ave_eigs[j] * m->ave_eigs[j]);
+      m->max_eigs[j] = ext[j];
+      m->min_eigs[j] = -ext[NCOL + j];
+    }
+  }
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+static void stat_track(int id, double x) {
+  stat_add(&(stats[id]), x);
+  acorr_add(&(acorrs[id]), x);
+}
+
+// Make and print the measurements due after trajectory traj (counting
+// from zero), returning a bit mask MEAS_BIT(id) of those made
+int measure(int traj, meas_t *m) {
+  int id, j, todo = 0;
+  double td, *corr;
+
+  if (!stats_ready) {
+    for (id = 0; id < N_STAT; id++) {
+      stat_init(&(stats[id]));
+      acorr_init(&(acorrs[id]));
+    }
+    stats_ready = 1;
+  }
+  for (id = 0; id < N_MEAS; id++) {
+    if (meas_every[id] > 0 && (traj % meas_every[id]) == meas_every[id] - 1)
+      todo |= MEAS_BIT(id);
+  }
+  if (todo & (MEAS_BIT(M_SCALAR_TRACE) | MEAS_BIT(M_ACTION)
+              | MEAS_BIT(M_SCALAR_EIG)))
+    site_sweep(todo, m);
+
+  // Tr[X^2] / N
+  if (todo & MEAS_BIT(M_SCALAR_TRACE)) {
+    node0_printf("SCALAR SQUARES");
+    for (j = 0; j < nscalar; j++)
+      node0_printf(" %.6g", m->Xtr[j]);
+    node0_printf(" %.6g %.6g\n", m->Xtr_ave, m->Xtr_width);
+  }
+
+  // Polyakov loop eigenvalues and trace
+  // Format: GMES Re(Polyakov) Im(Poyakov)
+  if (todo & MEAS_BIT(M_PLOOP)) {
+    m->plp = ploop_eig();
+    td = cabs(&(m->plp));
+    node0_printf("GMES %.8g %.8g\n", m->plp.real, m->plp.imag);
+    node0_printf("Poloop RMS %.8g\n", td);
+  }
+
+  // Bosonic action, and the bias whose exponential is the weight of
+  // this configuration in unbiased averages
+  if (todo & MEAS_BIT(M_ACTION)) {
+    node0_printf("b_act/nt %.8g\n", m->b_act / (double)nt);
+#ifdef PLOOP_BIAS
+    m->bias = bias_action();
+#endif
+  }
+
+  // Scalar eigenvalues
+  // Format: SCALAR_EIG # ave width min max
+  if (todo & MEAS_BIT(M_SCALAR_EIG)) {
+    for (j = 0; j < NCOL; j++) {
+      node0_printf("SCALAR_EIG %d %.6g %.6g %.6g %.6g\n", j, m->ave_eigs[j],
+                   m->eig_widths[j], m->min_eigs[j], m->max_eigs[j]);
+    }
+  }
+
+  // Scalar correlators for tau = 0, ..., MAX_T
+  // Format: SCALAR_CORR C(0) C(1) ...
+  if (todo & MEAS_BIT(M_CORR)) {
+    corr = scalar_corr();
+    node0_printf("SCALAR_CORR");
+    for (j = 0; j <= MAX_T; j++)
+      node0_printf(" %.6g", corr[j]);
+    node0_printf("\n");
+  }
+
+  // Feed the streaming statistics
+  if (todo & MEAS_BIT(M_SCALAR_TRACE))
+    stat_track(S_XTR, m->Xtr_ave);
+  if (todo & MEAS_BIT(M_ACTION))
+    stat_track(S_BACT, m->b_act / (double)nt);
+  if (todo & MEAS_BIT(M_PLOOP)) {
+    stat_track(S_REP, m->plp.real);
+    stat_track(S_ABSP, td);
+  }
+  if (todo & MEAS_BIT(M_SCALAR_EIG))
+    stat_track(S_EIG, m->ave_eigs[NCOL - 1]);
+
+  // Components of the action for reweighting, with the other
+  // observables made on this trajectory
+  obs_record(traj, todo, m);
+  return todo;
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Print the statistics of every observable measured so far
+// Format: STAT name N mean err_naive err_binned level
+//              err_jack variance err_variance
+// err_binned comes from blocks of 2^level measurements
+// Then the integrated autocorrelation times since the last change of
+// spacing, and the cost in seconds of each independent measurement,
+// 2 tau_int trajectories of sec_per_traj each
+// Format: TAU name N spacing tau_int err window ok tau_traj cost
+// tau_int is in units of the spacing and tau_traj in trajectories,
+// and ok = 0 means the window was not found, so tau is a lower bound
+void measure_report(double sec_per_traj) {
+  int id, W, ok, every;
+  double tau, dtau;
+
+  if (!stats_ready)
+    return;
+  for (id = 0; id < N_STAT; id++) {
+    if (stat_count(&(stats[id])) > 0)
+      stat_print(stat_name[id], &(stats[id]));
+  }
+  for (id = 0; id < N_STAT; id++) {
+    if (acorrs[id].n == 0)
+      continue;
+    ok = acorr_tau(&(acorrs[id]), &tau, &dtau, &W);
+    every = meas_every[stat_meas[id]];
+    node0_printf("TAU %s %ld %d %.4g %.4g %d %d %.4g %.4g\n", stat_name[id],
+                 acorrs[id].n, every, tau, dtau, W, ok, tau * every,
+                 2.0 * tau * every * sec_per_traj);
+  }
+}
+
+// Set the spacing of the expensive measurements (Polyakov loop and scalar
+// eigenvalues) to meas_tau_factor times the largest reliable tau_int
+// among all observables, in trajectories, but at least one
+// Changes by less than a quarter are ignored, to avoid following noise
+// in the estimates
+// Measurements that are switched off stay off, and the autocorrelations
+// of those whose spacing changes start again
+void measure_adjust() {
+  int id, k, W, every, old, expensive[2] = {M_PLOOP, M_SCALAR_EIG};
+  double tau, dtau, tau_max = 0.0;
+
+  if (!stats_ready || meas_tau_factor <= 0.0)
+    return;
+  for (id = 0; id < N_STAT; id++) {
+    if (acorr_tau(&(acorrs[id]), &tau, &dtau, &W) && W > 0) {
+      tau *= meas_every[stat_meas[id]];
+      if (tau > tau_max)
+        tau_max = tau;
+    }
+  }
+  if (tau_max == 0.0)
+    return;
+
+  every = (int)ceil(meas_tau_factor * tau_max);
+  if (every < 1)
+    every = 1;
+  for (k = 0; k < 2; k++) {
+    old = meas_every[expensive[k]];
+    if (old <= 0 || 4 * abs(every - old) < old || every == old)
+      continue;
+    node0_printf("MEAS_SPACING %s %d -> %d\n", meas_tag[expensive[k]],
+                 old, every);
+    meas_every[expensive[k]] = every;
+    for (id = 0; id < N_STAT; id++) {
+      if (stat_meas[id] == expensive[k])
+        acorr_init(&(acorrs[id]));
+    }
+  }
+}
+
+// Whether the binned error of every scheduled observable except Re(P)
+// is below target relative to its mean, with enough measurements for
+// the binned error to be trusted
+int measure_converged(double target) {
+  int id, level;
+  double err, mean;
+  stat_t *st;
+
+  if (!stats_ready)
+    return 0;
+  for (id = 0; id < N_STAT; id++) {
+    if (id == S_REP || meas_every[stat_meas[id]] <= 0)
+      continue;
+    st = &(stats[id]);
+    if (stat_count(st) < 4 * STAT_MIN_BLOCKS)
+      return 0;
+    err = stat_err(st, &level);
+    mean = fabs(stat_mean(st));
+    if (mean == 0.0 || err > target * mean)
+      return 0;
+  }
+  return 1;
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Measure b_act/nt, Xtr_ave and |P| after warmup trajectory traj
+// (counting from zero), without printing, and return 1 once the MSER
+// rule finds none of them drifting
+// The history holds at most warms trajectories, and is freed when
+// thermalization is found
+int measure_thermalized(int traj) {
+  int k, d[3];
+  complex plp;
+  meas_t m;
+  static int ready = 0;
+  static therm_t th[3];
+
+  if (!ready) {
+    for (k = 0; k < 3; k++)
+      therm_init(&(th[k]), warms);
+    ready = 1;
+  }
+  site_sweep(MEAS_BIT(M_SCALAR_TRACE) | MEAS_BIT(M_ACTION), &m);
+  plp = ploop();
+  therm_add(&(th[0]), m.b_act / (double)nt);
+  therm_add(&(th[1]), m.Xtr_ave);
+  therm_add(&(th[2]), cabs(&plp));
+
+  for (k = 0; k < 3; k++) {
+    d[k] = therm_mser(&(th[k]));
+    if (d[k] < 0)
+      return 0;
+  }
+  node0_printf("THERMALIZED after %d trajectories, ", traj + 1);
+  node0_printf("MSER truncation %d %d %d\n", d[0], d[1], d[2]);
+  for (k = 0; k < 3; k++)
+    therm_free(&(th[k]));
+  ready = 0;
+  return 1;
+}
+// -----------------------------------------------------------------
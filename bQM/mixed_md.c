@@ -0,0 +1,470 @@
+// -----------------------------------------------------------------
+// Mixed-precision molecular dynamics
+// Compiled with MIXED_MD in place of update_u() in update_leapfrog.c
+// and bosonic_force() in update_h.c
+//
+// The links, scalars and momenta stay double precision between
+// trajectories.  mixed_md_begin() copies them to the single-precision
+// fields below at the start of update_step(), the whole trajectory
+// including the gathers then runs on these copies, and mixed_md_end()
+// writes the result back into the proposal buffer and the momenta
+// reunitarize(), action() and the accept/reject test are unchanged and
+// work in double precision, and a rejected proposal never touches the
+// accepted fields
+//
+// The libraries are built for a single PRECISION, so the few NCOLxNCOL
+// kernels needed here are written out for fmatrix and fanti_hermitmat
+#include "bQM_includes.h"
+
+#ifdef MIXED_MD
+// Single-precision links, scalars and momenta, with workspace for the
+// gauge force and the conjugated scalars, allocated on first use
+static fmatrix *f_links = NULL, *f_U;
+static fanti_hermitmat *f_mom, *f_X[NSCALAR], *f_mom_X[NSCALAR];
+static fanti_hermitmat *f_temp_X[NSCALAR];
+
+// Each copy reads one precision and writes the other,
+// and is timed as an extra update_u
+#define COPY_BYTES (1.5 * ((1.0 + 2.0 * nscalar) * AH_BYTES + MAT_BYTES))
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Single-precision versions of the library routines of the same name
+static void uncompress_anti_hermitian_f(fanti_hermitmat *src,
+                                        fmatrix *dest) {
+  int i, j, index = 0;
+
+  for (i = 0; i < NCOL; i++) {
+    dest->e[i][i].imag = src->im_diag[i];
+    dest->e[i][i].real = 0.0;
+  }
+  for (i = 0; i < NCOL; i++) {
+    for (j = i + 1; j < NCOL; j++) {
+      dest->e[i][j].imag = src->m[index].imag;
+      dest->e[j][i].imag = src->m[index].imag;
+      dest->e[i][j].real = src->m[index].real;
+      dest->e[j][i].real = -src->m[index].real;
+      index++;
+    }
+  }
+}
+
+static void compress_anti_hermitian_f(fmatrix *src, fanti_hermitmat *dest) {
+  int i, j, index = 0;
+
+  for (i = 0; i < NCOL; i++)
+    dest->im_diag[i] = src->e[i][i].imag;
+  for (i = 0; i < NCOL; i++) {
+    for (j = i + 1; j < NCOL; j++) {
+      dest->m[index].real = src->e[i][j].real;
+      dest->m[index].imag = src->e[i][j].imag;
+      index++;
+    }
+  }
+}
+
+static void make_anti_hermitian_f(fmatrix *src, fanti_hermitmat *dest) {
+  int i, j, index = 0;
+  float tr;
+
+  tr = src->e[0][0].imag;
+  for (i = 1; i < NCOL; i++)
+    tr += src->e[i][i].imag;
+  tr /= (float)NCOL;
+  for (i = 0; i < NCOL; i++)
+    dest->im_diag[i] = src->e[i][i].imag - tr;
+  for (i = 0; i < NCOL; i++) {
+    for (j = i + 1; j < NCOL; j++) {
+      dest->m[index].real = 0.5 * (src->e[i][j].real - src->e[j][i].real);
+      dest->m[index].imag = 0.5 * (src->e[i][j].imag + src->e[j][i].imag);
+      index++;
+    }
+  }
+}
+
+// c = a * b, or c += a * b if sum is set
+static void mult_nn_f(fmatrix *a, fmatrix *b, fmatrix *c, int sum) {
+  register int i, j, k;
+  register float re, im;
+
+  for (i = 0; i < NCOL; i++) {
+    for (j = 0; j < NCOL; j++) {
+      re = (sum ? c->e[i][j].real : 0.0);
+      im = (sum ? c->e[i][j].imag : 0.0);
+      for (k = 0; k < NCOL; k++) {
+        re += a->e[i][k].real * b->e[k][j].real
+            - a->e[i][k].imag * b->e[k][j].imag;
+        im += a->e[i][k].imag * b->e[k][j].real
+            + a->e[i][k].real * b->e[k][j].imag;
+      }
+      c->e[i][j].real = re;
+      c->e[i][j].imag = im;
+    }
+  }
+}
+
+// c = a * bdag
+static void mult_na_f(fmatrix *a, fmatrix *b, fmatrix *c) {
+  register int i, j, k;
+  register float re, im;
+
+  for (i = 0; i < NCOL; i++) {
+    for (j = 0; j < NCOL; j++) {
+      re = 0.0;
+      im = 0.0;
+      for (k = 0; k < NCOL; k++) {
+        re += a->e[i][k].real * b->e[j][k].real
+            + a->e[i][k].imag * b->e[j][k].imag;
+        im += a->e[i][k].imag * b->e[j][k].real
+            - a->e[i][k].real * b->e[j][k].imag;
+      }
+      c->e[i][j].real = re;
+      c->e[i][j].imag = im;
+    }
+  }
+}
+
+// c = adag * b
+static void mult_an_f(fmatrix *a, fmatrix *b, fmatrix *c) {
+  register int i, j, k;
+  register float re, im;
+
+  for (i = 0; i < NCOL; i++) {
+    for (j = 0; j < NCOL; j++) {
+      re = 0.0;
+      im = 0.0;
+      for (k = 0; k < NCOL; k++) {
+        re += a->e[k][i].real * b->e[k][j].real
+            + a->e[k][i].imag * b->e[k][j].imag;
+        im += a->e[k][i].real * b->e[k][j].imag
+            - a->e[k][i].imag * b->e[k][j].real;
+      }
+      c->e[i][j].real = re;
+      c->e[i][j].imag = im;
+    }
+  }
+}
+
+// c = a + s * b
+static void scalar_mult_add_matrix_f(fmatrix *a, fmatrix *b, float s,
+                                     fmatrix *c) {
+  register int i, j;
+
+  for (i = 0; i < NCOL; i++) {
+    for (j = 0; j < NCOL; j++) {
+      c->e[i][j].real = a->e[i][j].real + s * b->e[i][j].real;
+      c->e[i][j].imag = a->e[i][j].imag + s * b->e[i][j].imag;
+    }
+  }
+}
+
+// c = a + s * b
+static void scalar_mult_add_ahmat_f(fanti_hermitmat *a, fanti_hermitmat *b,
+                                    float s, fanti_hermitmat *c) {
+  register int i;
+
+  for (i = 0; i < NCOL; i++)
+    c->im_diag[i] = a->im_diag[i] + s * b->im_diag[i];
+  for (i = 0; i < N_OFFDIAG; i++) {
+    c->m[i].real = a->m[i].real + s * b->m[i].real;
+    c->m[i].imag = a->m[i].imag + s * b->m[i].imag;
+  }
+}
+
+// Re Tr[adag b], accumulated in double precision
+static double realtrace_ahmat_f(fanti_hermitmat *a, fanti_hermitmat *b) {
+  register int i;
+  register double diag = 0.0, offdiag = 0.0;
+
+  for (i = 0; i < NCOL; i++)
+    diag += (double)a->im_diag[i] * (double)b->im_diag[i];
+  for (i = 0; i < N_OFFDIAG; i++) {
+    offdiag += (double)a->m[i].real * (double)b->m[i].real
+             + (double)a->m[i].imag * (double)b->m[i].imag;
+  }
+  return diag + 2.0 * offdiag;
+}
+
+static double realtrace_f(fmatrix *a, fmatrix *b) {
+  register int i, j;
+  register double sum = 0.0;
+
+  for (i = 0; i < NCOL; i++) {
+    for (j = 0; j < NCOL; j++) {
+      sum += (double)a->e[i][j].real * (double)b->e[i][j].real
+           + (double)a->e[i][j].imag * (double)b->e[i][j].imag;
+    }
+  }
+  return sum;
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Conversions between the two precisions
+static void mat_to_f(matrix *src, fmatrix *dest) {
+  register int i, j;
+
+  for (i = 0; i < NCOL; i++) {
+    for (j = 0; j < NCOL; j++) {
+      dest->e[i][j].real = (float)src->e[i][j].real;
+      dest->e[i][j].imag = (float)src->e[i][j].imag;
+    }
+  }
+}
+
+static void mat_from_f(fmatrix *src, matrix *dest) {
+  register int i, j;
+
+  for (i = 0; i < NCOL; i++) {
+    for (j = 0; j < NCOL; j++) {
+      dest->e[i][j].real = (Real)src->e[i][j].real;
+      dest->e[i][j].imag = (Real)src->e[i][j].imag;
+    }
+  }
+}
+
+static void ahmat_to_f(anti_hermitmat *src, fanti_hermitmat *dest) {
+  register int i;
+
+  for (i = 0; i < NCOL; i++)
+    dest->im_diag[i] = (float)src->im_diag[i];
+  for (i = 0; i < N_OFFDIAG; i++) {
+    dest->m[i].real = (float)src->m[i].real;
+    dest->m[i].imag = (float)src->m[i].imag;
+  }
+}
+
+static void ahmat_from_f(fanti_hermitmat *src, anti_hermitmat *dest) {
+  register int i;
+
+  for (i = 0; i < NCOL; i++)
+    dest->im_diag[i] = (Real)src->im_diag[i];
+  for (i = 0; i < N_OFFDIAG; i++) {
+    dest->m[i].real = (Real)src->m[i].real;
+    dest->m[i].imag = (Real)src->m[i].imag;
+  }
+}
+
+// Allocate the single-precision fields on first use
+static void alloc_f_fields() {
+  int j, fail;
+
+  if (f_links != NULL)
+    return;
+  f_links = malloc(sizeof *f_links * sites_on_node);
+  f_U = malloc(sizeof *f_U * sites_on_node);
+  f_mom = malloc(sizeof *f_mom * sites_on_node);
+  fail = (f_links == NULL || f_U == NULL || f_mom == NULL);
+  for (j = 0; j < nscalar; j++) {
+    f_X[j] = malloc(sizeof *f_X[j] * sites_on_node);
+    f_mom_X[j] = malloc(sizeof *f_mom_X[j] * sites_on_node);
+    f_temp_X[j] = malloc(sizeof *f_temp_X[j] * sites_on_node);
+    if (f_X[j] == NULL || f_mom_X[j] == NULL || f_temp_X[j] == NULL)
+      fail = 1;
+  }
+  if (fail) {
+    printf("alloc_f_fields: node%d can't malloc fields\n", this_node);
+    terminate(1);
+  }
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Copy the active fields and the momenta to single precision
+void mixed_md_begin() {
+  register int i, j;
+  register site *s;
+
+  alloc_f_fields();
+  TIC(T_UPDATE_U)
+  FORALLSITES(i, s) {
+    mat_to_f(&(links[i]), &(f_links[i]));
+    ahmat_to_f(&(s->mom), &(f_mom[i]));
+    for (j = 0; j < nscalar; j++) {
+      ahmat_to_f(&(X[j][i]), &(f_X[j][i]));
+      ahmat_to_f(&(s->mom_X[j]), &(f_mom_X[j][i]));
+    }
+  }
+  TOC(T_UPDATE_U, 0.0, sites_on_node * COPY_BYTES)
+}
+
+// Write the evolved fields into the proposal buffer,
+// and the momenta back to double precision for action()
+void mixed_md_end() {
+  register int i, j;
+  register site *s;
+  int buf = update_target();
+
+  TIC(T_UPDATE_U)
+  FORALLSITES(i, s) {
+    mat_from_f(&(f_links[i]), &(link_buf[buf][i]));
+    ahmat_from_f(&(f_mom[i]), &(s->mom));
+    for (j = 0; j < nscalar; j++) {
+      ahmat_from_f(&(f_X[j][i]), &(X_buf[buf][j][i]));
+      ahmat_from_f(&(f_mom_X[j][i]), &(s->mom_X[j]));
+    }
+  }
+  TOC(T_UPDATE_U, 0.0, sites_on_node * COPY_BYTES)
+  finish_update(buf);
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Single-precision update_u(), see update_leapfrog.c
+// The copies are updated in place, since mixed_md_end() takes care of
+// the proposal buffer
+void update_u(Real eps) {
+  register int i, j;
+  register site *s;
+  register float t2, t3, t4, t5, t6, t7, t8, feps = (float)eps;
+  fmatrix tmat, tmat2, tmp_mom;
+
+  t2 = eps / 2.0;
+  t3 = eps / 3.0;
+  t4 = eps / 4.0;
+  t5 = eps / 5.0;
+  t6 = eps / 6.0;
+  t7 = eps / 7.0;
+  t8 = eps / 8.0;
+
+  TIC(T_UPDATE_U)
+  FORALLSITES(i, s) {
+    uncompress_anti_hermitian_f(&(f_mom[i]), &tmp_mom);
+    mult_nn_f(&tmp_mom, &(f_links[i]), &tmat, 0);
+    scalar_mult_add_matrix_f(&(f_links[i]), &tmat, t8, &tmat2);
+
+    mult_nn_f(&tmp_mom, &tmat2, &tmat, 0);
+    scalar_mult_add_matrix_f(&(f_links[i]), &tmat, t7, &tmat2);
+
+    mult_nn_f(&tmp_mom, &tmat2, &tmat, 0);
+    scalar_mult_add_matrix_f(&(f_links[i]), &tmat, t6, &tmat2);
+
+    mult_nn_f(&tmp_mom, &tmat2, &tmat, 0);
+    scalar_mult_add_matrix_f(&(f_links[i]), &tmat, t5, &tmat2);
+
+    mult_nn_f(&tmp_mom, &tmat2, &tmat, 0);
+    scalar_mult_add_matrix_f(&(f_links[i]), &tmat, t4, &tmat2);
+
+    mult_nn_f(&tmp_mom, &tmat2, &tmat, 0);
+    scalar_mult_add_matrix_f(&(f_links[i]), &tmat, t3, &tmat2);
+
+    mult_nn_f(&tmp_mom, &tmat2, &tmat, 0);
+    scalar_mult_add_matrix_f(&(f_links[i]), &tmat, t2, &tmat2);
+
+    mult_nn_f(&tmp_mom, &tmat2, &tmat, 0);
+    scalar_mult_add_matrix_f(&(f_links[i]), &tmat, feps, &(f_links[i]));
+
+    for (j = 0; j < nscalar; j++) {
+      scalar_mult_add_ahmat_f(&(f_X[j][i]), &(f_mom_X[j][i]), feps,
+                              &(f_X[j][i]));
+    }
+  }
+  TOC(T_UPDATE_U, sites_on_node * UPDATE_U_FLOPS,
+      sites_on_node * 0.5 * UPDATE_U_BYTES)
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Single-precision bosonic_force(), see update_h.c for the terms
+// Only the force norm is accumulated in double precision
+double bosonic_force(Real eps) {
+  register int i, j;
+  register site *s;
+  float tr, tr2;
+  double returnit = 0.0;
+  fmatrix tmat, tmat2;
+  fanti_hermitmat f_X_force;
+  msg_tag *tag[NSCALAR], *tag2[NSCALAR];
+
+  TIC(T_FORCE)
+  FORALLSITES(i, s) {
+    for (j = 0; j < NCOL * NCOL; j++) {
+      f_U[i].e[j / NCOL][j % NCOL].real = 0.0;
+      f_U[i].e[j / NCOL][j % NCOL].imag = 0.0;
+    }
+  }
+
+  // Gather X(n+1), and Udag(n-1) X(n-1) U(n-1)
+  for (j = 0; j < nscalar; j++) {
+    tag[j] = start_gather_field(f_X[j], sizeof(fanti_hermitmat),
+                               TUP, EVENANDODD, gen_pt[j]);
+  }
+  for (j = 0; j < nscalar; j++) {
+    FORALLSITES(i, s) {
+      uncompress_anti_hermitian_f(&(f_X[j][i]), &tmat2);
+      mult_nn_f(&tmat2, &(f_links[i]), &tmat, 0);
+      mult_an_f(&(f_links[i]), &tmat, &tmat2);
+      compress_anti_hermitian_f(&tmat2, &(f_temp_X[j][i]));
+    }
+    tag2[j] = start_gather_field(f_temp_X[j], sizeof(fanti_hermitmat),
+                                 TDOWN, EVENANDODD, gen_pt[NSCALAR + j]);
+  }
+
+  // Gauge force 2 U(n) X(n+1) Udag(n) X(n)
+  for (j = 0; j < nscalar; j++) {
+    TIC(T_GATHER)
+    wait_gather(tag[j]);
+    TOC(T_GATHER, 0.0, 0.5 * GATHER_AH_BYTES)
+    FORALLSITES(i, s) {
+      uncompress_anti_hermitian_f((fanti_hermitmat *)(gen_pt[j][i]), &tmat);
+      mult_na_f(&tmat, &(f_links[i]), &tmat2);
+      mult_nn_f(&(f_links[i]), &tmat2, &tmat, 0);
+      uncompress_anti_hermitian_f(&(f_X[j][i]), &tmat2);
+      mult_nn_f(&tmat2, &tmat, &(f_U[i]), 1);
+    }
+  }
+
+  tr = 4.0 * eps * beta; // !!!
+  FORALLSITES(i, s) {
+    uncompress_anti_hermitian_f(&(f_mom[i]), &tmat);
+    scalar_mult_add_matrix_f(&tmat, &(f_U[i]), -tr, &tmat);
+    make_anti_hermitian_f(&tmat, &(f_mom[i]));
+    returnit += 16.0 * realtrace_f(&(f_U[i]), &(f_U[i]));
+  }
+
+  // Scalar force -2(2+omega^2) X(n) + 2 U(n) X(n+1) Udag(n)
+  //   + 2 Udag(n-1) X(n-1) U(n-1)
+  tr = -2.0 - omega * omega;
+  tr2 = 2.0 * eps * beta;
+  for (j = 0; j < nscalar; j++) {
+    TIC(T_GATHER)
+    wait_gather(tag2[j]);
+    TOC(T_GATHER, 0.0, 0.5 * GATHER_AH_BYTES)
+    FORALLSITES(i, s) {
+      uncompress_anti_hermitian_f((fanti_hermitmat *)(gen_pt[j][i]), &tmat);
+      mult_na_f(&tmat, &(f_links[i]), &tmat2);
+      mult_nn_f(&(f_links[i]), &tmat2, &tmat, 0);
+      make_anti_hermitian_f(&tmat, &f_X_force);
+
+      scalar_mult_add_ahmat_f(&f_X_force, &(f_X[j][i]), tr, &f_X_force);
+      scalar_mult_add_ahmat_f(&f_X_force,
+                              (fanti_hermitmat *)(gen_pt[NSCALAR + j][i]),
+                              1.0, &f_X_force);
+
+      scalar_mult_add_ahmat_f(&(f_mom_X[j][i]), &f_X_force, tr2,
+                              &(f_mom_X[j][i]));
+      returnit += 4.0 * realtrace_ahmat_f(&f_X_force, &f_X_force);
+    }
+    cleanup_gather(tag[j]);
+    cleanup_gather(tag2[j]);
+  }
+  TIC(T_REDUCE)
+  g_doublesum(&returnit);
+  TOC(T_REDUCE, 0.0, REDUCE_BYTES)
+
+  TOC(T_FORCE, sites_on_node * FORCE_FLOPS,
+      sites_on_node * 0.5 * FORCE_BYTES)
+  return (eps * beta * sqrt(returnit) / (double)nt);
+}
+#endif
+// -----------------------------------------------------------------
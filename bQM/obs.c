@@ -0,0 +1,64 @@
+// -----------------------------------------------------------------
+// Binary stream of observables for each measured trajectory, for
+// reweighting with bQM_reweight (control_reweight.c) and other analyses
+// Format, in the native byte order:
+//   int    OBS_VERSION, nt, NCOL, nscalar
+//   double beta, omega
+// followed by one record of OBS_NREC doubles for each trajectory on
+// which the action was measured:
+//   traj, mask, sqterms, hopterms, Xtr_ave, Re(P), Im(P), |P|, bias
+// where mask holds the MEAS_BIT()s of the observables measured on
+// that trajectory, and the others are zero
+// bias is the Polyakov loop bias V(q) of bias.c, zero without PLOOP_BIAS,
+// so that exp(bias) reweights the record to the unbiased ensemble
+// Version 1 streams lack bias
+// sqterms and hopterms are the sums in bosonic_action(), so that
+//   S = beta [(2 + omega^2) sqterms + 2 hopterms]
+// can be evaluated for any beta and omega
+// Only node0 writes, and nothing is written if obs_file is "none"
+#include "bQM_includes.h"
+
+static FILE *obs_fp = NULL;
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Write the record for trajectory traj, given the measurements todo
+void obs_record(int traj, int todo, meas_t *m) {
+  int header[4] = {OBS_VERSION, nt, NCOL, nscalar};
+  double par[2] = {beta, omega}, rec[OBS_NREC];
+
+  if (this_node != 0 || !(todo & MEAS_BIT(M_ACTION))
+      || strcmp(obs_file, "none") == 0)
+    return;
+  if (obs_fp == NULL) {
+    obs_fp = fopen(obs_file, "wb");
+    if (obs_fp == NULL) {
+      printf("obs_record: can't open %s\n", obs_file);
+      terminate(1);
+    }
+    fwrite(header, sizeof(int), 4, obs_fp);
+    fwrite(par, sizeof(double), 2, obs_fp);
+  }
+
+  rec[0] = (double)traj;
+  rec[1] = (double)todo;
+  rec[2] = m->sqterms;
+  rec[3] = m->hopterms;
+  rec[4] = (todo & MEAS_BIT(M_SCALAR_TRACE) ? m->Xtr_ave : 0.0);
+  rec[5] = (todo & MEAS_BIT(M_PLOOP) ? m->plp.real : 0.0);
+  rec[6] = (todo & MEAS_BIT(M_PLOOP) ? m->plp.imag : 0.0);
+  rec[7] = (todo & MEAS_BIT(M_PLOOP) ? cabs(&(m->plp)) : 0.0);
+  rec[8] = m->bias;
+  if (fwrite(rec, sizeof(double), OBS_NREC, obs_fp) != OBS_NREC)
+    printf("obs_record: error writing %s\n", obs_file);
+  fflush(obs_fp);
+}
+
+void obs_close() {
+  if (obs_fp != NULL)
+    fclose(obs_fp);
+  obs_fp = NULL;
+}
+// -----------------------------------------------------------------
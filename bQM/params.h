@@ -10,18 +10,45 @@ typedef struct {
   // Initialization parameters
   int nt;                 // Lattice dimensions
   int iseed;              // For random numbers
+  int ncol;               // Must match the compiled NCOL
+  int nscalar;            // Number of scalars, at most NSCALAR
 
   int warms;              // The number of warmup trajectories
+  int therm_detect;       // Whether to stop warmups once thermalized
   int trajecs;            // The number of real trajectories
   Real traj_length;       // The length of each trajectory
   int nsteps;             // Steps per trajectory
-  int propinterval;       // Number of trajectories between measurements
+  int propinterval;       // Number of trajectories between reports
+  int meas_every[N_MEAS]; // The same for each observable in measure.c
+  Real stop_rel_err;      // Relative error for stopping early, 0 for never
+  Real meas_tau_factor;   // Expensive spacing over tau_int, 0 for fixed
+  Real hist_eig_max;      // Eigenvalue histogram range, 0 for none
   int startflag;          // What to do for beginning lattice
   int fixflag;            // Whether to gauge fix to Coulomb gauge
   int saveflag;           // What to do with lattice at end
   Real beta;              // Gauge coupling
   Real omega;             // Quadratic regulator
+#ifdef SCALAR_HEATBATH
+  int nover;              // Overrelaxation sweeps per heatbath sweep
+#endif
+#ifdef GHMC
+  Real ghmc_angle;        // Momentum mixing angle
+#endif
+#ifdef LINK_METROPOLIS
+  int link_sweeps;        // SU(2) subgroup sweeps per trajectory
+  Real link_step;         // Width of the SU(2) proposals
+#endif
+#ifdef PLOOP_BIAS
+  Real bias_kappa;        // Umbrella strength, 0 for none
+  Real bias_q0;           // Umbrella centre
+  Real bias_height;       // Metadynamics hill height, 0 for none
+  Real bias_width;        // Metadynamics hill width
+  int bias_stride;        // Trajectories between hills
+  Real bias_dT;           // Well-tempering, 0 for plain metadynamics
+#endif
   char startfile[MAXFILENAME], savefile[MAXFILENAME];
+  char hist_file[MAXFILENAME];
+  char obs_file[MAXFILENAME];
 } params;
 #endif
 // -----------------------------------------------------------------
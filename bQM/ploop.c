@@ -1,8 +1,16 @@
 // -----------------------------------------------------------------
 // Evaluate the Polyakov loop using repeated single-timeslice gathers
 // Use tempmat and tempmat2 for temporary storage
+// Also the prefix transport along the line used by corr.c and bias.c
 #include "bQM_includes.h"
 
+// One block product from each node, allocated on first use
+static double *blocks = NULL;
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
 complex ploop() {
   register int i, index = node_index(0);
   register site *s;
@@ -12,18 +20,18 @@ complex ploop() {
 
   // Special case: nt == 1 (i.e., a single-site 'lattice', s=0)
   if (nt == 1) {
-    plp = trace(&(lattice[index].link));
+    plp = trace(&(links[index]));
     return plp;
   }
 
   // Compute line by steadily shifting links to hyperplane 0
   FORALLSITES(i, s)
-    mat_copy(&(s->link), &(tempmat[i]));
+    mat_copy(&(links[i]), &(tempmat[i]));
 
   for (t = 1; t < nt; t++) {
     shiftmat(tempmat, tempmat2, TUP);
     if (t == 1)
-      mult_nn(&(lattice[index].link), &(tempmat[index]), &tmat);
+      mult_nn(&(links[index]), &(tempmat[index]), &tmat);
     else {
       mult_nn(&tmat, &(tempmat[index]), &(tempmat2[index]));
       mat_copy(&(tempmat2[index]), &tmat);
@@ -41,3 +49,73 @@ complex ploop() {
   return plp;
 }
 // -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Prefix transport P[i] = U(0) ... U(t - 1) for each site i of this node,
+// at time t, and the Polyakov loop L = U(0) ... U(nt - 1) on every node
+// Each node holds the timeslices t0 <= t < t0 + sites_on_node (see
+// layout_hyper_prime.c) and multiplies along them, then the nodes
+// exchange these block products, a single matrix each, so the cost
+// per node goes as sites_on_node + number_of_nodes rather than nt
+void line_prefix(matrix *P, matrix *L) {
+  register int i, k, a;
+  register site *s;
+  int t, t0 = nt;
+  double *d;
+  matrix Q, tmat;
+
+  if (blocks == NULL) {
+    blocks = malloc(sizeof *blocks * 2 * number_of_nodes * NCOL * NCOL);
+    if (blocks == NULL) {
+      printf("line_prefix: node%d can't malloc blocks\n", this_node);
+      terminate(1);
+    }
+  }
+
+  // Product along this node's block
+  FORALLSITES(i, s) {
+    if (s->t < t0)
+      t0 = s->t;
+  }
+  for (a = 0; a < NCOL * NCOL; a++)
+    Q.e[a / NCOL][a % NCOL] = cmplx(a / NCOL == a % NCOL ? 1.0 : 0.0, 0.0);
+  for (t = t0; t < t0 + sites_on_node; t++) {
+    i = node_index(t);
+    mat_copy(&Q, &(P[i]));
+    mult_nn(&(P[i]), &(links[i]), &Q);
+  }
+
+  // Collect the block products, in order along the line
+  for (a = 0; a < 2 * number_of_nodes * NCOL * NCOL; a++)
+    blocks[a] = 0.0;
+  d = blocks + 2 * this_node * NCOL * NCOL;
+  for (a = 0; a < NCOL * NCOL; a++) {
+    *d++ = Q.e[a / NCOL][a % NCOL].real;
+    *d++ = Q.e[a / NCOL][a % NCOL].imag;
+  }
+  g_vecdoublesum(blocks, 2 * number_of_nodes * NCOL * NCOL);
+
+  // Transport to the start of this node's block and around the line
+  for (k = 0; k < number_of_nodes; k++) {
+    if (k == this_node && k > 0) {
+      FORALLSITES(i, s) {
+        mult_nn(L, &(P[i]), &tmat);
+        mat_copy(&tmat, &(P[i]));
+      }
+    }
+    d = blocks + 2 * k * NCOL * NCOL;
+    for (a = 0; a < NCOL * NCOL; a++) {
+      tmat.e[a / NCOL][a % NCOL].real = *d++;
+      tmat.e[a / NCOL][a % NCOL].imag = *d++;
+    }
+    if (k == 0)
+      mat_copy(&tmat, L);
+    else {
+      mult_nn(L, &tmat, &Q);
+      mat_copy(&Q, L);
+    }
+  }
+}
+// -----------------------------------------------------------------
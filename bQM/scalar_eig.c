@@ -1,23 +1,62 @@
 // -----------------------------------------------------------------
 // Average and extremal scalar eigenvalues, and widths of distributions
-// Use LAPACK for arbitrary NCOL
+// The eigenvalues of the anti-hermitian X are i times those of the
+// hermitian -iX, which herm_eig_batch() diagonalizes for all sites and
+// scalars at once
 // Note two-color trace subtraction --> +/- eigenvalue pairs
+// scalar_eig_load() and scalar_eig_local() let measure.c fill the batch
+// in its own site loop and combine the reductions with other observables
 
 // #define SCALAR_EIG_DIST prints out all eigenvalues for plotting distribution
 // CAUTION: Do not run SCALAR_EIG_DIST with MPI!
+// The histograms in hist.c give the same distribution in parallel
 
 //#define SCALAR_EIG_DIST
 #include "bQM_includes.h"
 
-void scalar_eig(double *ave_eigs, double *eig_widths,
-                double *min_eigs, double *max_eigs) {
+// Workspace for the batch, allocated on first use
+static matrix *Hbatch = NULL;
+static double *Ebatch;
+// -----------------------------------------------------------------
 
-  register int i;
+
+
+// -----------------------------------------------------------------
+// Store H = -iX for every scalar on site i in the batch
+void scalar_eig_load(int i) {
+  register int j, a, b;
+  int n = sites_on_node * nscalar;
+  matrix tmat, *H;
+
+  if (Hbatch == NULL) {
+    Hbatch = malloc(sizeof *Hbatch * n);
+    Ebatch = malloc(sizeof *Ebatch * n * NCOL);
+    if (Hbatch == NULL || Ebatch == NULL) {
+      printf("scalar_eig: node%d can't malloc workspace\n", this_node);
+      terminate(1);
+    }
+  }
+
+  for (j = 0; j < nscalar; j++) {
+    uncompress_anti_hermitian(&(X[j][i]), &tmat);
+    H = &(Hbatch[i * nscalar + j]);
+    for (a = 0; a < NCOL; a++) {
+      for (b = 0; b < NCOL; b++) {
+        H->e[a][b].real = tmat.e[a][b].imag;
+        H->e[a][b].imag = -tmat.e[a][b].real;
+      }
+    }
+  }
+}
+
+// Diagonalize the loaded batch, and accumulate this node's sums of the
+// eigenvalues and their squares, and their extrema, all NCOL long
+// The caller initializes and reduces these
+void scalar_eig_local(double *sum, double *sq, double *min, double *max) {
+  register int i, k;
   register site *s;
-  char N = 'N';     // Ask LAPACK only for eigenvalues
-  char U = 'U';     // Have LAPACK store upper triangle of U.Ubar
-  int row, col, Npt = NCOL, stat = 0, Nwork = 2 * NCOL, j, k;
-  double sq_eigs[NCOL], norm = 1.0 / (double)(NSCALAR * nt);
+  int j, n = sites_on_node * nscalar;
+  double *eigs;
 
 #ifdef SCALAR_EIG_DIST
   if (this_node != 0) {
@@ -27,31 +66,14 @@ void scalar_eig(double *ave_eigs, double *eig_widths,
   }
 #endif
 
-  // Initialize averages and extrema
-  for (j = 0; j < NCOL; j++) {
-    ave_eigs[j] = 0.0;
-    min_eigs[j] =  99.0;
-    max_eigs[j] = -99.0;
-    sq_eigs[j] = 0.0;
-  }
+  TIC(T_SCALAR_EIG)
+  herm_eig_batch(Hbatch, n, Ebatch);
+  TOC(T_SCALAR_EIG, n * SCALAR_EIG_FLOPS, n * (AH_BYTES + MAT_BYTES))
 
   FORALLSITES(i, s) {
-    for (j = 0; j < NSCALAR; j++) {
-      // Convert X[j] to column-major double array used by LAPACK
-      for (row = 0; row < NCOL; row++) {
-        for (col = 0; col < NCOL; col++) {
-          store[2 * (col * NCOL + row)] = s->X[j].e[row][col].real;
-          store[2 * (col * NCOL + row) + 1] = s->X[j].e[row][col].imag;
-        }
-      }
-
-      // Compute eigenvalues and eigenvectors of X[j]
-      zheev_(&N, &U, &Npt, store, &Npt, eigs, work, &Nwork, Rwork, &stat);
-
-      // Make sure eigenvalues are always ordered consistently
-      if (stat != 0)
-        printf("WARNING: Non-zero return for %d\n", s->t);
-
+    for (j = 0; j < nscalar; j++) {
+      // Eigenvalues are in ascending order
+      eigs = Ebatch + (i * nscalar + j) * NCOL;
 #ifdef SCALAR_EIG_DIST
       printf("SCALAR EIG DIST ");
       printf("%d %d", s->t, j);
@@ -60,17 +82,45 @@ void scalar_eig(double *ave_eigs, double *eig_widths,
       printf("\n");
 #endif
 
+      hist_scalar(eigs);
+
       // Average eigenvalues, monitor minimum and maximum
       for (k = 0; k < NCOL; k++) {
-        ave_eigs[k] += eigs[k];
-        sq_eigs[k] += eigs[k] * eigs[k];
-        if (eigs[k] > max_eigs[k])
-          max_eigs[k] = eigs[k];
-        if (eigs[k] < min_eigs[k])
-          min_eigs[k] = eigs[k];
+        sum[k] += eigs[k];
+        sq[k] += eigs[k] * eigs[k];
+        if (eigs[k] > max[k])
+          max[k] = eigs[k];
+        if (eigs[k] < min[k])
+          min[k] = eigs[k];
       }
     }
   }
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+void scalar_eig(double *ave_eigs, double *eig_widths,
+                double *min_eigs, double *max_eigs) {
+
+  register int i;
+  register site *s;
+  int j;
+  double sq_eigs[NCOL], norm = 1.0 / (double)(nscalar * nt);
+
+  // Initialize averages and extrema
+  for (j = 0; j < NCOL; j++) {
+    ave_eigs[j] = 0.0;
+    min_eigs[j] =  99.0;
+    max_eigs[j] = -99.0;
+    sq_eigs[j] = 0.0;
+  }
+
+  // H = -iX for every site and scalar, then all eigenvalues at once
+  FORALLSITES(i, s)
+    scalar_eig_load(i);
+  scalar_eig_local(ave_eigs, sq_eigs, min_eigs, max_eigs);
 
   // Finalize averages, extrema and square root of variance
   for (j = 0; j < NCOL; j++) {
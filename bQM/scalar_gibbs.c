@@ -0,0 +1,204 @@
+// -----------------------------------------------------------------
+// Exact heatbath for the scalars given the gauge field,
+// compiled with SCALAR_GIBBS
+// Expanding each scalar in the orthonormal anti-hermitian basis
+//   X(t) = sum_A x_A(t) T_A,  T_A = i Lambda_A / sqrt(2),
+//   Re Tr[T_A^dag T_B] = delta_AB
+// the bosonic action of action.c is, for every scalar separately,
+//   beta [(2+omega^2) sum_t x(t).x(t) - 2 sum_t x(t).R(t) x(t+1)]
+// with the adjoint link R_AB(t) = -Re Tr[T_A U(t) T_B Udag(t)]
+// This is x^T Q x with Q periodic block-tridiagonal in t,
+// so each scalar is an independent draw from exp(-x^T Q x)
+//
+// Each node computes R on its own sites, the global sum gives every
+// node all nt blocks, and node 0 factorizes Q = L L^T and solves
+// L^T x = z for all scalars at once, with gaussian z of variance 1/2
+// The result is broadcast so each node can fill in its own sites
+// The Cholesky factor of the periodic matrix has one extra block row
+// (the last time slice couples back to the first), so the cost is
+// O(nt NADJ^3), with blocks handled by LAPACK/BLAS in column-major order
+#include "bQM_includes.h"
+
+#ifdef SCALAR_GIBBS
+// Orthonormal anti-hermitian basis, and workspace allocated on first use
+static matrix T[NADJ_DIM];
+static double *R = NULL, *L, *S, *F, *E, *x;
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Set up the basis from Lambda (hermitian with Tr[Lambda_A Lambda_B]
+// = 2 delta_AB, see setup_lambda.c) and allocate the workspace
+static void setup_gibbs() {
+  register int a, b, A;
+  int m2 = NADJ * NADJ;
+  Real norm = 1.0 / sqrt(2.0);
+
+  if (nt < 3) {
+    node0_printf("ERROR: SCALAR_GIBBS needs nt >= 3\n");
+    terminate(1);
+  }
+  for (A = 0; A < NADJ; A++) {
+    for (a = 0; a < NCOL; a++) {
+      for (b = 0; b < NCOL; b++) {
+        T[A].e[a][b].real = -norm * Lambda[A].e[a][b].imag;
+        T[A].e[a][b].imag = norm * Lambda[A].e[a][b].real;
+      }
+    }
+  }
+
+  R = malloc(sizeof *R * nt * m2);
+  L = malloc(sizeof *L * nt * m2);
+  S = malloc(sizeof *S * (nt - 1) * m2);
+  F = malloc(sizeof *F * (nt - 2) * m2);
+  E = malloc(sizeof *E * m2);
+  x = malloc(sizeof *x * nt * NADJ * NSCALAR);
+  if (R == NULL || L == NULL || S == NULL || F == NULL || E == NULL
+      || x == NULL) {
+    printf("setup_gibbs: node%d can't malloc workspace\n", this_node);
+    terminate(1);
+  }
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Block Cholesky factorization of Q, on node 0
+// Blocks of L below the diagonal: S[t] = L(t+1, t) for t < nt-1
+// and F[t] = L(nt-1, t) for t < nt-2 (fill-in from the periodic corner)
+static void factor_Q() {
+  register int A, B, t;
+  int m = NADJ, m2 = NADJ * NADJ, n = nt, info = 0;
+  double one = 1.0, mone = -1.0, diag = beta * (2.0 + omega * omega);
+  double *Lt, *St, *Ft, *Llast = L + (n - 1) * m2;
+  char Lc = 'L', Rc = 'R', Nc = 'N', Tc = 'T';
+
+  // Diagonal blocks start as beta (2+omega^2), only the lower half is used
+  // Sub-diagonal Q(t+1, t) = -beta R(t)^T and corner Q(n-1, 0) = -beta R(n-1)
+  for (t = 0; t < n; t++) {
+    for (A = 0; A < m2; A++)
+      L[t * m2 + A] = 0.0;
+    for (A = 0; A < m; A++)
+      L[t * m2 + A * (m + 1)] = diag;
+  }
+  for (t = 0; t < n - 1; t++) {
+    for (A = 0; A < m; A++) {
+      for (B = 0; B < m; B++)
+        S[t * m2 + A + m * B] = -beta * R[t * m2 + B + m * A];
+    }
+  }
+  for (A = 0; A < m2; A++)
+    E[A] = -beta * R[(n - 1) * m2 + A];
+
+  for (t = 0; t < n - 1; t++) {
+    Lt = L + t * m2;
+    St = S + t * m2;
+    dpotrf_(&Lc, &m, Lt, &m, &info);
+    if (info != 0) {
+      printf("factor_Q: dpotrf failed with info %d at t = %d\n", info, t);
+      terminate(1);
+    }
+    dtrsm_(&Rc, &Lc, &Tc, &Nc, &m, &m, &one, Lt, &m, St, &m);
+    dsyrk_(&Lc, &Nc, &m, &m, &mone, St, &m, &one, Lt + m2, &m);
+    if (t < n - 2) {
+      // Last block row: F[t] = E L(t,t)^{-T}, pushed on to the next column
+      Ft = F + t * m2;
+      for (A = 0; A < m2; A++)
+        Ft[A] = E[A];
+      dtrsm_(&Rc, &Lc, &Tc, &Nc, &m, &m, &one, Lt, &m, Ft, &m);
+      dsyrk_(&Lc, &Nc, &m, &m, &mone, Ft, &m, &one, Llast, &m);
+      if (t < n - 3) {
+        for (A = 0; A < m2; A++)
+          E[A] = 0.0;
+        dgemm_(&Nc, &Tc, &m, &m, &m, &mone, Ft, &m, St, &m, &one, E, &m);
+      }
+      else      // Next column is the sub-diagonal block Q(n-1, n-2)
+        dgemm_(&Nc, &Tc, &m, &m, &m, &mone, Ft, &m, St, &m, &one,
+               St + m2, &m);
+    }
+  }
+  dpotrf_(&Lc, &m, Llast, &m, &info);
+  if (info != 0) {
+    printf("factor_Q: dpotrf failed with info %d at t = %d\n", info, n - 1);
+    terminate(1);
+  }
+}
+
+// Solve L^T x = z for gaussian z, all scalars at once, on node 0
+// x holds one NADJ x nscalar column-major block per time slice
+static void sample_x() {
+  register int i, t;
+  int m = NADJ, m2 = NADJ * NADJ, n = nt, ns = nscalar;
+  double one = 1.0, mone = -1.0, *xt, *xlast = x + (n - 1) * m * ns;
+  char Lc = 'L', Nc = 'N', Tc = 'T';
+
+  for (i = 0; i < n * m * ns; i++)
+    x[i] = gaussian_rand_no(&node_prn);
+
+  dtrsm_(&Lc, &Lc, &Tc, &Nc, &m, &ns, &one, L + (n - 1) * m2, &m, xlast, &m);
+  for (t = n - 2; t >= 0; t--) {
+    xt = x + t * m * ns;
+    dgemm_(&Tc, &Nc, &m, &ns, &m, &mone, S + t * m2, &m, xt + m * ns, &m,
+           &one, xt, &m);
+    if (t < n - 2)
+      dgemm_(&Tc, &Nc, &m, &ns, &m, &mone, F + t * m2, &m, xlast, &m,
+             &one, xt, &m);
+    dtrsm_(&Lc, &Lc, &Tc, &Nc, &m, &ns, &one, L + t * m2, &m, xt, &m);
+  }
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Replace all scalars by an exact draw given the current links
+void scalar_gibbs() {
+  register int i, j, A, B;
+  register site *s;
+  int m2 = NADJ * NADJ;
+  double *Rt, *xt;
+  matrix M, tmat, tmat2;
+
+  TIC(T_GIBBS)
+  if (R == NULL)
+    setup_gibbs();
+
+  // Adjoint links on this node's sites, zero elsewhere
+  for (i = 0; i < nt * m2; i++)
+    R[i] = 0.0;
+  FORALLSITES(i, s) {
+    Rt = R + s->t * m2;
+    for (B = 0; B < NADJ; B++) {
+      mult_na(&(T[B]), &(links[i]), &tmat);
+      mult_nn(&(links[i]), &tmat, &M);
+      for (A = 0; A < NADJ; A++)
+        Rt[A + NADJ * B] = -realtrace_nn(&(T[A]), &M);
+    }
+  }
+  TIC(T_REDUCE)
+  g_vecdoublesum(R, nt * m2);
+  TOC(T_REDUCE, 0.0, nt * m2 * REDUCE_BYTES)
+
+  if (this_node == 0) {
+    factor_Q();
+    sample_x();
+  }
+  broadcast_bytes((char *)x, nt * NADJ * nscalar * sizeof(double));
+
+  FORALLSITES(i, s) {
+    xt = x + s->t * NADJ * nscalar;
+    for (j = 0; j < nscalar; j++) {
+      clear_mat(&tmat);
+      for (A = 0; A < NADJ; A++) {
+        scalar_mult_add_matrix(&tmat, &(T[A]), xt[A + NADJ * j], &tmat2);
+        mat_copy(&tmat2, &tmat);
+      }
+      compress_anti_hermitian(&tmat, &(X[j][i]));
+    }
+  }
+  TOC(T_GIBBS, sites_on_node * GIBBS_FLOPS, sites_on_node * GIBBS_BYTES)
+}
+#endif
+// -----------------------------------------------------------------
@@ -0,0 +1,108 @@
+// -----------------------------------------------------------------
+// Local checkerboard heatbath and overrelaxation for the scalars,
+// compiled with SCALAR_HEATBATH
+// With nearest-neighbour hopping, each X_j(t) given its neighbours has
+//   S = beta (2+omega^2) Re Tr[(X - M)^dag (X - M)] + const
+// with conditional mean M = F / (2+omega^2) from the transported neighbours
+//   F(t) = U(t) X(t+1) Udag(t) + Udag(t-1) X(t-1) U(t-1)
+// the same combination as the scalar force in update_h.c
+// All sites of one parity are therefore independent given the other:
+//   heatbath       X = M + eta / sqrt(2 beta (2+omega^2))
+//   overrelaxation X = 2M - X
+// where eta from random_anti_hermitian() has unit variance in each
+// orthonormal component Re Tr[T_A^dag T_B] = delta_AB
+// Overrelaxation keeps the action fixed, and moves far through the
+// distribution when the conditional width is small
+//
+// Each half-sweep starts the gathers of the opposite-parity X(t+1) and
+// Udag(t-1) X(t-1) U(t-1) for all scalars together and waits once
+#include "bQM_includes.h"
+
+#ifdef SCALAR_HEATBATH
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Heatbath (over = 0) or overrelaxation (over = 1) for the scalars
+// on sites of the given parity
+static void scalar_half_sweep(int parity, int over) {
+  register int i, j;
+  register site *s;
+  int opp = (parity == EVEN ? ODD : EVEN);
+  Real tr = 1.0 / (2.0 + omega * omega);
+  Real width = sqrt(0.5 * tr / beta);
+  matrix tmat, tmat2;
+  anti_hermitmat M, eta;
+  msg_tag *tag[NSCALAR], *tag2[NSCALAR];
+
+  // Udag(t) X(t) U(t) on the opposite parity, for the backward term
+  for (j = 0; j < nscalar; j++) {
+    FORSOMEPARITY(i, s, opp) {
+      uncompress_anti_hermitian(&(X[j][i]), &tmat2);
+      mult_nn(&tmat2, &(links[i]), &tmat);
+      mult_an(&(links[i]), &tmat, &tmat2);
+      compress_anti_hermitian(&tmat2, &(temp_X[j][i]));
+    }
+  }
+  for (j = 0; j < nscalar; j++) {
+    tag[j] = start_gather_field(X[j], sizeof(anti_hermitmat),
+                               TUP, parity, gen_pt[j]);
+    tag2[j] = start_gather_field(temp_X[j], sizeof(anti_hermitmat),
+                                 TDOWN, parity, gen_pt[NSCALAR + j]);
+  }
+  TIC(T_GATHER)
+  for (j = 0; j < nscalar; j++) {
+    wait_gather(tag[j]);
+    wait_gather(tag2[j]);
+  }
+  TOC(T_GATHER, 0.0, 2.0 * nscalar * GATHER_AH_BYTES)
+
+  FORSOMEPARITY(i, s, parity) {
+    for (j = 0; j < nscalar; j++) {
+      // Conditional mean M = F / (2+omega^2)
+      uncompress_anti_hermitian((anti_hermitmat *)(gen_pt[j][i]), &tmat);
+      mult_na(&tmat, &(links[i]), &tmat2);
+      scalar_mult_nn(&(links[i]), &tmat2, tr, &tmat);
+      make_anti_hermitian(&tmat, &M);
+      scalar_mult_sum_ahmat((anti_hermitmat *)(gen_pt[NSCALAR + j][i]), tr,
+                            &M);
+      if (over) {         // X + 2(M - X)
+        scalar_mult_sum_ahmat(&(X[j][i]), -1.0, &M);
+        scalar_mult_add_ahmat(&(X[j][i]), &M, 2.0, &(X[j][i]));
+      }
+      else {
+        random_anti_hermitian(&eta, &(s->site_prn));
+        scalar_mult_add_ahmat(&M, &eta, width, &(X[j][i]));
+      }
+    }
+  }
+  for (j = 0; j < nscalar; j++) {
+    cleanup_gather(tag[j]);
+    cleanup_gather(tag2[j]);
+  }
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// One heatbath sweep followed by nover overrelaxation sweeps,
+// each sweep updating the even sites and then the odd sites
+void scalar_heatbath() {
+  int n;
+
+  if (nt % 2 != 0) {
+    node0_printf("ERROR: SCALAR_HEATBATH needs even nt\n");
+    terminate(1);
+  }
+  TIC(T_HEATBATH)
+  for (n = 0; n <= nover; n++) {
+    scalar_half_sweep(EVEN, n > 0);
+    scalar_half_sweep(ODD, n > 0);
+  }
+  TOC(T_HEATBATH, (1.0 + nover) * sites_on_node * HEATBATH_FLOPS,
+      (1.0 + nover) * sites_on_node * HEATBATH_BYTES)
+}
+#endif
+// -----------------------------------------------------------------
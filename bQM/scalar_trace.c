@@ -8,11 +8,11 @@ double scalar_trace(double *Xtr, double *Xwidth) {
   register site *s;
   double Xtr_ave = 0.0, XtrSq = 0.0, td;
 
-  for (j = 0; j < NSCALAR; j++) {
+  for (j = 0; j < nscalar; j++) {
     Xtr[j] = 0.0;
     FORALLSITES(i, s) {
       // Take adjoint of first to get rid of overall negative sign
-      td = realtrace(&(s->X[j]), &(s->X[j]));
+      td = realtrace_ahmat(&(X[j][i]), &(X[j][i]));
       Xtr[j] += td;
       XtrSq += td * td;
     }
@@ -20,8 +20,8 @@ double scalar_trace(double *Xtr, double *Xwidth) {
     g_doublesum(&(Xtr[j]));
     Xtr_ave += Xtr[j];
   }
-  Xtr_ave /= (double)NSCALAR;
-  XtrSq *= one_ov_N * one_ov_N / ((double)nt * NSCALAR);
+  Xtr_ave /= (double)nscalar;
+  XtrSq *= one_ov_N * one_ov_N / ((double)nt * nscalar);
   g_doublesum(&XtrSq);
   *Xwidth = sqrt(XtrSq - Xtr_ave * Xtr_ave);
 
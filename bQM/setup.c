@@ -17,7 +17,11 @@ int initial_set() {
   int prompt = 0, status = 0;
   if (mynode() == 0) {
     // Print banner
+#ifdef NCOL_DYN
+    printf("Bosonic QM, Nc = ncol from the input\n");
+#else
     printf("Bosonic QM, Nc = %d\n", NCOL);
+#endif
     printf("Microcanonical simulation with refreshing\n");
     printf("Machine = %s, with %d nodes\n", machine_type(), numnodes());
 #ifdef HMC_ALGORITHM
@@ -34,6 +38,8 @@ int initial_set() {
 
     IF_OK status += get_i(stdin, prompt, "nt", &par_buf.nt);
     IF_OK status += get_i(stdin, prompt, "iseed", &par_buf.iseed);
+    IF_OK status += get_i(stdin, prompt, "ncol", &par_buf.ncol);
+    IF_OK status += get_i(stdin, prompt, "nscalar", &par_buf.nscalar);
 
     if (status > 0)
       par_buf.stopflag = 1;
@@ -48,13 +54,36 @@ int initial_set() {
 
   nt = par_buf.nt;
   iseed = par_buf.iseed;
+  nscalar = par_buf.nscalar;
+#ifdef NCOL_DYN
+  ncol_dyn = par_buf.ncol;
+#endif
 
   // Lattice volume sanity checks, including dimensional reduction
+  // The matrix types are sized at compile time, so ncol only checks
+  // that the input matches this binary, or for NCOL_DYN that it fits
   if (mynode() == 0) {
     if (nt < 1) {
       printf("nt must be positive\n");
       exit(1);
     }
+#ifdef NCOL_DYN
+    if (NCOL < NCOL_PP || NCOL > NCOL_MAX) {
+      printf("ncol %d must be between %d and NCOL_MAX = %d\n",
+             NCOL, NCOL_PP, NCOL_MAX);
+      exit(1);
+    }
+#else
+    if (par_buf.ncol != NCOL) {
+      printf("ncol %d doesn't match this binary, compiled with NCOL %d\n",
+             par_buf.ncol, NCOL);
+      exit(1);
+    }
+#endif
+    if (nscalar < 1 || nscalar > NSCALAR) {
+      printf("nscalar must be between 1 and NSCALAR = %d\n", NSCALAR);
+      exit(1);
+    }
   }
 
   this_node = mynode();
@@ -69,11 +98,27 @@ int initial_set() {
 // -----------------------------------------------------------------
 // Allocate space for fields
 void make_fields() {
+  int buf, nbuf = 1;
+#ifdef HMC_ALGORITHM
+  nbuf = 2;       // Current and proposal configurations
+#endif
+
+  // Gauge links and scalars, cur_buf holds the initial configuration
+  // Only the nscalar scalars in use are allocated
+  Real size = (Real)(nbuf * (sizeof(matrix)
+                             + nscalar * sizeof(anti_hermitmat)));
+  for (buf = 0; buf < nbuf; buf++)
+    FIELD_ALLOC(link_buf[buf], matrix);
+  FIELD_ALLOC_MAT(X_buf, anti_hermitmat, nbuf, nscalar);
+  cur_buf = 0;
+  prop_pending = 0;
+  set_active_fields(cur_buf);
+
   // Temporary matrices and Fermions
-  Real size = (Real)((2.0 + NSCALAR) * sizeof(matrix));
+  size += (Real)(2.0 * sizeof(matrix) + nscalar * sizeof(anti_hermitmat));
   FIELD_ALLOC(tempmat, matrix);
   FIELD_ALLOC(tempmat2, matrix);
-  FIELD_ALLOC_VEC(temp_X, matrix, NSCALAR);
+  FIELD_ALLOC_VEC(temp_X, anti_hermitmat, nscalar);
 
   size *= sites_on_node;
   node0_printf("Mallocing %.1f MBytes per core for fields\n", size / 1e6);
@@ -110,7 +155,7 @@ int setup() {
 // Read in parameters for Monte Carlo
 // prompt=1 indicates prompts are to be given for input
 int readin(int prompt) {
-  int status;
+  int status, j;
 
   // On node zero, read parameters and send to all other nodes
   if (this_node == 0) {
@@ -119,19 +164,74 @@ int readin(int prompt) {
 
     // Warms, trajecs
     IF_OK status += get_i(stdin, prompt, "warms", &par_buf.warms);
+    IF_OK status += get_i(stdin, prompt, "therm_detect",
+                          &par_buf.therm_detect);
     IF_OK status += get_i(stdin, prompt, "trajecs", &par_buf.trajecs);
     IF_OK status += get_f(stdin, prompt, "traj_length", &par_buf.traj_length);
 
     // Number of steps
     IF_OK status += get_i(stdin, prompt, "nstep", &par_buf.nsteps);
 
-    // Trajectories between expensive measurements
+    // Trajectories between reports of the statistics in measure.c
     IF_OK status += get_i(stdin, prompt, "traj_between_meas",
                           &par_buf.propinterval);
 
+    // Trajectories between each scheduled observable, zero for never
+    for (j = 0; j < N_MEAS; j++) {
+      IF_OK status += get_i(stdin, prompt, meas_tag[j],
+                            &par_buf.meas_every[j]);
+    }
+
+    // Relative error of all scheduled observables at which to stop
+    IF_OK status += get_f(stdin, prompt, "stop_rel_err",
+                          &par_buf.stop_rel_err);
+
+    // Spacing of expensive measurements over tau_int, zero to keep fixed
+    IF_OK status += get_f(stdin, prompt, "meas_tau_factor",
+                          &par_buf.meas_tau_factor);
+
+    // Eigenvalue histograms, with their file only if switched on
+    IF_OK status += get_f(stdin, prompt, "hist_eig_max",
+                          &par_buf.hist_eig_max);
+    if (par_buf.hist_eig_max > 0.0) {
+      IF_OK status += get_s(stdin, prompt, "hist_file", par_buf.hist_file);
+    }
+
+    // Binary stream of observables for reweighting, or "none"
+    IF_OK status += get_s(stdin, prompt, "obs_file", par_buf.obs_file);
+
     // beta, omega
     IF_OK status += get_f(stdin, prompt, "beta", &par_buf.beta);
     IF_OK status += get_f(stdin, prompt, "omega", &par_buf.omega);
+#ifdef SCALAR_HEATBATH
+    IF_OK status += get_i(stdin, prompt, "nover", &par_buf.nover);
+#endif
+#ifdef GHMC
+    IF_OK status += get_f(stdin, prompt, "ghmc_angle", &par_buf.ghmc_angle);
+#endif
+#ifdef LINK_METROPOLIS
+    IF_OK status += get_i(stdin, prompt, "link_sweeps", &par_buf.link_sweeps);
+    IF_OK status += get_f(stdin, prompt, "link_step", &par_buf.link_step);
+#endif
+#ifdef PLOOP_BIAS
+    // Umbrella and metadynamics, each followed by its other parameters
+    // only if switched on
+    IF_OK status += get_f(stdin, prompt, "bias_kappa", &par_buf.bias_kappa);
+    if (par_buf.bias_kappa > 0.0) {
+      IF_OK status += get_f(stdin, prompt, "bias_q0", &par_buf.bias_q0);
+    }
+    IF_OK status += get_f(stdin, prompt, "bias_height", &par_buf.bias_height);
+    if (par_buf.bias_height > 0.0) {
+      IF_OK status += get_f(stdin, prompt, "bias_width", &par_buf.bias_width);
+      IF_OK status += get_i(stdin, prompt, "bias_stride",
+                            &par_buf.bias_stride);
+      IF_OK status += get_f(stdin, prompt, "bias_dT", &par_buf.bias_dT);
+      if (par_buf.bias_width <= 0.0 || par_buf.bias_stride < 1) {
+        printf("bias_width and bias_stride must be positive\n");
+        status++;
+      }
+    }
+#endif
 
     // Find out what kind of starting lattice to use
     IF_OK status += ask_starting_lattice(stdin, prompt, &par_buf.startflag,
@@ -153,13 +253,39 @@ int readin(int prompt) {
     normal_exit(0);
 
   warms = par_buf.warms;
+  therm_detect = par_buf.therm_detect;
   trajecs = par_buf.trajecs;
   traj_length = par_buf.traj_length;
   nsteps = par_buf.nsteps;
   propinterval = par_buf.propinterval;
+  for (j = 0; j < N_MEAS; j++)
+    meas_every[j] = par_buf.meas_every[j];
+  stop_rel_err = par_buf.stop_rel_err;
+  meas_tau_factor = par_buf.meas_tau_factor;
+  hist_eig_max = par_buf.hist_eig_max;
+  strcpy(hist_file, par_buf.hist_file);
+  strcpy(obs_file, par_buf.obs_file);
 
   beta = par_buf.beta;
   omega = par_buf.omega;
+#ifdef SCALAR_HEATBATH
+  nover = par_buf.nover;
+#endif
+#ifdef GHMC
+  ghmc_angle = par_buf.ghmc_angle;
+#endif
+#ifdef LINK_METROPOLIS
+  link_sweeps = par_buf.link_sweeps;
+  link_step = par_buf.link_step;
+#endif
+#ifdef PLOOP_BIAS
+  bias_kappa = par_buf.bias_kappa;
+  bias_q0 = par_buf.bias_q0;
+  bias_height = par_buf.bias_height;
+  bias_width = par_buf.bias_width;
+  bias_stride = par_buf.bias_stride;
+  bias_dT = par_buf.bias_dT;
+#endif
 
   startflag = par_buf.startflag;
   saveflag = par_buf.saveflag;
@@ -181,6 +307,9 @@ int readin(int prompt) {
 
   // Do whatever is needed to get lattice
   startlat_p = reload_lattice(startflag, startfile);
+#ifdef STATIC_GAUGE
+  setup_static_gauge();
+#endif
 
   return 0;
 }
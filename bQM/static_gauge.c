@@ -0,0 +1,249 @@
+// -----------------------------------------------------------------
+// Static diagonal gauge, compiled with STATIC_GAUGE
+// In one dimension every link can be gauge-rotated to the same constant
+// diagonal matrix D = diag(exp(i theta_a / nt)), so that the Polyakov loop
+// is diag(exp(i theta_a)); the NCOL eigenphases theta_a (summing to zero)
+// are then the only gauge degrees of freedom
+// The gauge fixing adds the Faddeev--Popov (Vandermonde) measure
+//   S_FP = -sum_{a<b} log sin^2[(theta_a - theta_b) / 2]
+// and the phases get momenta theta_mom with kinetic term sum_a p_a^2 / 2
+//
+// The links field still holds D at every site, so the scalar action and
+// force are unchanged, while update_u() and ploop_eig() here replace the
+// general versions and no reunitarization is needed
+#include "bQM_includes.h"
+
+#ifdef STATIC_GAUGE
+// Tolerance for recognizing a reloaded static-gauge lattice,
+// which may have been saved in single precision
+#define STATIC_TOL 1.0e-5
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Remove the trace of a vector of NCOL phases or phase momenta
+void traceless_theta(Real *v) {
+  register int a;
+  Real tr = 0.0;
+
+  for (a = 0; a < NCOL; a++)
+    tr += v[a];
+  tr *= one_ov_N;
+  for (a = 0; a < NCOL; a++)
+    v[a] -= tr;
+}
+
+// Fill dest with the diagonal link D(theta) on every site
+void static_links(matrix *dest) {
+  register int i, a;
+  register site *s;
+  matrix D;
+
+  clear_mat(&D);
+  for (a = 0; a < NCOL; a++)
+    D.e[a][a] = ce_itheta(theta[a] / (Real)nt);
+  FORALLSITES(i, s)
+    mat_copy(&D, &(dest[i]));
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Set up the phases after the starting lattice has been loaded
+// A fresh start spreads them evenly over (-pi / 2, pi / 2), since
+// coincident phases have infinite Faddeev--Popov action, while an even
+// spread over the full circle would make the Polyakov loop vanish
+// A reloaded lattice must come from a static-gauge run: the phases are
+// read off the first link, and all links must be that diagonal matrix
+void setup_static_gauge() {
+  register int i, a, b;
+  register site *s;
+  int bad = 0;
+  Real diff;
+
+  if (startflag == FRESH) {
+    for (a = 0; a < NCOL; a++)
+      theta[a] = 0.5 * PI * (2.0 * a - NCOL + 1.0) / (Real)NCOL;
+  }
+  else {
+    if (this_node == 0) {
+      for (a = 0; a < NCOL; a++)
+        theta[a] = nt * carg(&(links[0].e[a][a]));
+    }
+    broadcast_bytes((char *)theta, NCOL * sizeof(Real));
+    traceless_theta(theta);
+
+    FORALLSITES(i, s) {
+      for (a = 0; a < NCOL; a++) {
+        for (b = 0; b < NCOL; b++) {
+          if (a == b) {
+            diff = carg(&(links[i].e[a][a])) - theta[a] / (Real)nt;
+            diff = fabs(diff - TWOPI * floor(diff / TWOPI + 0.5));
+          }
+          else
+            diff = cabs(&(links[i].e[a][b]));
+          if (diff > STATIC_TOL)
+            bad = 1;
+        }
+      }
+    }
+    g_intsum(&bad);
+    if (bad > 0) {
+      node0_printf("ERROR: STATIC_GAUGE needs a starting lattice with ");
+      node0_printf("the same diagonal link on every site\n");
+      terminate(1);
+    }
+  }
+  static_links(links);
+  for (a = 0; a < NCOL; a++)
+    old_theta[a] = theta[a];
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Gaussian random phase momenta with <p^2> = 1, to match the kinetic
+// term, generated on node 0 so that all nodes agree,
+// then projected to the traceless subspace
+void ranmom_theta() {
+  register int a;
+
+  if (this_node == 0) {
+    for (a = 0; a < NCOL; a++)
+      theta_mom[a] = sqrt(2.0) * gaussian_rand_no(&node_prn);
+  }
+  broadcast_bytes((char *)theta_mom, NCOL * sizeof(Real));
+  traceless_theta(theta_mom);
+}
+
+// Kinetic term for the phase momenta
+double theta_mom_action() {
+  register int a;
+  double sum = 0.0;
+
+  for (a = 0; a < NCOL; a++)
+    sum += 0.5 * theta_mom[a] * theta_mom[a];
+  return sum;
+}
+
+// Faddeev--Popov action -sum_{a<b} log sin^2[(theta_a - theta_b) / 2]
+double vandermonde_action() {
+  register int a, b;
+  double sum = 0.0, sn;
+
+  for (a = 0; a < NCOL; a++) {
+    for (b = a + 1; b < NCOL; b++) {
+      sn = sin(0.5 * (theta[a] - theta[b]));
+      sum -= log(sn * sn);
+    }
+  }
+  return sum;
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Update theta_mom with the force on the phases, given the gauge force
+// collectors f_U = sum_j X_j(n) M_j(n) with M_j(n) = D X_j(n+1) Ddag
+// from bosonic_force()
+// The hopping term 2 beta Re Tr[X D X(n+1) Ddag] depends on theta_c through
+//   d/dtheta_c Tr[X M] = (i / nt) [(M X)_cc - (X M)_cc]
+//                      = (2 / nt) Im (X M)_cc
+// since X and M are anti-hermitian
+// The Faddeev--Popov force is -sum_{b != c} cot[(theta_c - theta_b) / 2]
+// Returns the squared force, summed over nodes
+double static_gauge_force(Real eps) {
+  register int i, a, b;
+  register site *s;
+  double force[NCOL], returnit = 0.0;
+
+  for (a = 0; a < NCOL; a++)
+    force[a] = 0.0;
+  FORALLSITES(i, s) {
+    for (a = 0; a < NCOL; a++)
+      force[a] += s->f_U.e[a][a].imag;
+  }
+  TIC(T_REDUCE)
+  g_vecdoublesum(force, NCOL);
+  TOC(T_REDUCE, 0.0, NCOL * REDUCE_BYTES)
+
+  for (a = 0; a < NCOL; a++) {
+    force[a] *= 4.0 * beta / (double)nt;
+    for (b = 0; b < NCOL; b++) {
+      if (b != a)
+        force[a] -= 1.0 / tan(0.5 * (theta[a] - theta[b]));
+    }
+  }
+
+  // Traceless, so that the phases keep summing to zero
+  for (a = 0; a < NCOL; a++)
+    theta_mom[a] -= eps * force[a];
+  traceless_theta(theta_mom);
+  for (a = 0; a < NCOL; a++)
+    returnit += force[a] * force[a];
+  return returnit;
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Move the phases and scalars, writing the new diagonal links
+// into the buffer chosen by update_target()
+void update_u(Real eps) {
+  register int i, j;
+  register site *s;
+  int buf = update_target();
+
+  TIC(T_UPDATE_U)
+  for (j = 0; j < NCOL; j++)
+    theta[j] += eps * theta_mom[j];
+  static_links(link_buf[buf]);
+
+  FORALLSITES(i, s) {
+    for (j = 0; j < nscalar; j++) {
+      scalar_mult_add_ahmat(&(X[j][i]), &(s->mom_X[j]), eps,
+                            &(X_buf[buf][j][i]));
+    }
+  }
+  TOC(T_UPDATE_U, sites_on_node * 2.0 * nscalar * NCOL * NCOL,
+      sites_on_node * (MAT_BYTES + 3.0 * nscalar * AH_BYTES))
+  finish_update(buf);
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Polyakov loop and its eigenphases, which are just the theta
+// Same output as the general ploop_eig.c
+complex ploop_eig() {
+  register int a;
+  double phases[NCOL];
+  complex plp = cmplx(0.0, 0.0), ceigs[NCOL];
+
+  TIC(T_PLOOP_EIG)
+  for (a = 0; a < NCOL; a++) {
+    ceigs[a] = ce_itheta(theta[a]);
+    CSUM(plp, ceigs[a]);
+  }
+  if (fabs(plp.imag) < IMAG_TOL)
+    plp.imag = 0.0;
+
+  // Phases relative to their circular mean, as in ploop_eig.c
+  centre_phases(ceigs, phases);
+  if (this_node == 0)
+    hist_phases(phases);
+  node0_printf("LINES_EIG");
+  for (a = 0; a < NCOL; a++)
+    node0_printf(" %.4g", phases[a]);
+  node0_printf("\n");
+  TOC(T_PLOOP_EIG, 0.0, 0.0)
+  return plp;
+}
+#endif
+// -----------------------------------------------------------------
@@ -0,0 +1,295 @@
+// -----------------------------------------------------------------
+// Streaming statistics for one observable, in O(log N) memory
+// Binning: level l holds blocks averaging 2^l consecutive measurements,
+// each completed as soon as two blocks from level l-1 are available,
+// with Welford's running mean and variance over the completed blocks
+// of every level
+// Level 0 gives the mean and variance of all N measurements, and
+// level l the error sqrt(var_l / n_l), which grows with l until the
+// blocks are longer than the autocorrelation time
+// Jackknife: STAT_NJACK bins of equal size, doubled by merging
+// neighbouring pairs whenever they are all full, give jackknife errors
+// for the mean and for the nonlinear variance <x^2> - <x>^2
+// Autocorrelations: the sums of x_i x_{i-t} for t < AC_WMAX, from a ring
+// of the last AC_WMAX values, give the integrated autocorrelation time
+// with the Madras--Sokal window, in O(AC_WMAX) memory and time per value
+// Thermalization: the MSER rule on means of THERM_BATCH consecutive
+// values, which keeps every batch mean of at most the warms trajectories
+#include "bQM_includes.h"
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+void stat_init(stat_t *st) {
+  register int l;
+
+  for (l = 0; l < STAT_LEVELS; l++) {
+    st->nb[l] = 0;
+    st->bmean[l] = 0.0;
+    st->bm2[l] = 0.0;
+    st->half[l] = 0;
+  }
+  st->nj = 0;
+  st->jsize = 1;
+  st->jn = 0;
+  st->jcur = 0.0;
+  st->jcur_sq = 0.0;
+}
+
+void stat_add(stat_t *st, double x) {
+  register int l;
+  double delta, block = x;
+
+  // Welford update at each level, carrying completed blocks upwards
+  for (l = 0; l < STAT_LEVELS; l++) {
+    st->nb[l]++;
+    delta = block - st->bmean[l];
+    st->bmean[l] += delta / (double)st->nb[l];
+    st->bm2[l] += delta * (block - st->bmean[l]);
+    if (!st->half[l]) {
+      st->pend[l] = block;
+      st->half[l] = 1;
+      break;
+    }
+    block = 0.5 * (st->pend[l] + block);
+    st->half[l] = 0;
+  }
+
+  // Jackknife bins, each used once it is full
+  st->jcur += x;
+  st->jcur_sq += x * x;
+  st->jn++;
+  if (st->jn < st->jsize)
+    return;
+  st->jsum[st->nj] = st->jcur;
+  st->jsq[st->nj] = st->jcur_sq;
+  st->nj++;
+  st->jn = 0;
+  st->jcur = 0.0;
+  st->jcur_sq = 0.0;
+  if (st->nj == STAT_NJACK) {
+    for (l = 0; l < STAT_NJACK / 2; l++) {
+      st->jsum[l] = st->jsum[2 * l] + st->jsum[2 * l + 1];
+      st->jsq[l] = st->jsq[2 * l] + st->jsq[2 * l + 1];
+    }
+    st->nj = STAT_NJACK / 2;
+    st->jsize *= 2;
+  }
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Number of measurements and their mean
+long stat_count(stat_t *st) {
+  return st->nb[0];
+}
+
+double stat_mean(stat_t *st) {
+  return st->bmean[0];
+}
+
+// Error of the mean from the blocks of level l, zero if too few
+double stat_level_err(stat_t *st, int l) {
+  if (l >= STAT_LEVELS || st->nb[l] < 2)
+    return 0.0;
+  return sqrt(st->bm2[l] / (st->nb[l] * (st->nb[l] - 1.0)));
+}
+
+// Binned error from the highest level with at least STAT_MIN_BLOCKS
+// blocks, which is returned in *level
+double stat_err(stat_t *st, int *level) {
+  register int l;
+
+  for (l = STAT_LEVELS - 1; l > 0; l--) {
+    if (st->nb[l] >= STAT_MIN_BLOCKS)
+      break;
+  }
+  *level = l;
+  return stat_level_err(st, l);
+}
+
+// Jackknife errors of the mean and of the variance over the full bins,
+// with the variance itself returned in *var
+void stat_jackknife(stat_t *st, double *mean_err, double *var,
+                    double *var_err) {
+  register int k;
+  double S = 0.0, Q = 0.0, M, mk, vk, vsum = 0.0, msq = 0.0, vsq = 0.0;
+  double mean, fac;
+
+  *mean_err = 0.0;
+  *var_err = 0.0;
+  *var = 0.0;
+  if (st->nj < 2)
+    return;
+  for (k = 0; k < st->nj; k++) {
+    S += st->jsum[k];
+    Q += st->jsq[k];
+  }
+  M = (double)st->nj * st->jsize;
+  mean = S / M;
+  *var = Q / M - mean * mean;
+
+  // Leave out one bin at a time
+  for (k = 0; k < st->nj; k++) {
+    mk = (S - st->jsum[k]) / (M - st->jsize);
+    vk = (Q - st->jsq[k]) / (M - st->jsize) - mk * mk;
+    msq += (mk - mean) * (mk - mean);
+    vsum += vk;
+    vsq += vk * vk;
+  }
+  fac = (st->nj - 1.0) / (double)st->nj;
+  *mean_err = sqrt(fac * msq);
+  vsum /= (double)st->nj;
+  vsq -= st->nj * vsum * vsum;      // May round below zero
+  if (vsq > 0.0)
+    *var_err = sqrt(fac * vsq);
+}
+
+// One line of the statistics report, see measure_report()
+void stat_print(char *name, stat_t *st) {
+  int level;
+  double err, mean_err, var, var_err;
+
+  err = stat_err(st, &level);
+  stat_jackknife(st, &mean_err, &var, &var_err);
+  node0_printf("STAT %s %ld %.8g %.4g %.4g %d %.4g %.6g %.4g\n",
+               name, stat_count(st), stat_mean(st), stat_level_err(st, 0),
+               err, level, mean_err, var, var_err);
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+void acorr_init(acorr_t *ac) {
+  register int t;
+
+  ac->n = 0;
+  ac->shift = 0.0;
+  ac->total = 0.0;
+  for (t = 0; t < AC_WMAX; t++)
+    ac->S[t] = 0.0;
+}
+
+void acorr_add(acorr_t *ac, double x) {
+  register int t;
+  long n = ac->n;
+
+  // Subtract the first value to avoid cancellations in Gamma(t)
+  if (n == 0)
+    ac->shift = x;
+  x -= ac->shift;
+  if (n < AC_WMAX)
+    ac->first[n] = x;
+  ac->ring[n % AC_WMAX] = x;
+  for (t = 0; t < AC_WMAX && t <= n; t++)
+    ac->S[t] += x * ac->ring[(n - t) % AC_WMAX];
+  ac->total += x;
+  ac->n++;
+}
+
+// Integrated autocorrelation time tau = 1/2 + sum_{t=1}^W rho(t)
+// in units of the spacing between values, with W the smallest window
+// with W >= AC_C tau, and the Madras--Sokal error
+// The autocovariance for each t < W is
+//   Gamma(t) = sum_{i=t}^{n-1} (x_i - m)(x_{i-t} - m) / (n - t)
+// expanded in terms of S[t] and the sums of the first and last t values
+// Returns 0 if the window is not reached within AC_WMAX or n / 2,
+// in which case tau is only a lower bound
+int acorr_tau(acorr_t *ac, double *tau, double *dtau, int *W) {
+  register int t;
+  long n = ac->n;
+  double m, gamma0, gamma, head = 0.0, tail = 0.0;
+
+  *tau = 0.5;
+  *dtau = 0.0;
+  *W = 0;
+  if (n < 2)
+    return 0;
+  m = ac->total / (double)n;
+  gamma0 = ac->S[0] / (double)n - m * m;
+  if (gamma0 <= 0.0)
+    return 1;
+
+  for (t = 1; t < AC_WMAX && t < n / 2; t++) {
+    head += ac->first[t - 1];
+    tail += ac->ring[(n - t) % AC_WMAX];
+    gamma = (ac->S[t] - m * (2.0 * ac->total - head - tail)) / (double)(n - t)
+          + m * m;
+    *tau += gamma / gamma0;
+    if (t >= AC_C * *tau) {
+      *W = t;
+      *dtau = *tau * sqrt(2.0 * (2.0 * t + 1.0) / (double)n);
+      return 1;
+    }
+  }
+  *W = t - 1;
+  return 0;
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Room for batch means of up to max_values values
+void therm_init(therm_t *th, int max_values) {
+  th->n = 0;
+  th->nin = 0;
+  th->cur = 0.0;
+  th->nmax = max_values / THERM_BATCH + 1;
+  th->batch = malloc(sizeof *(th->batch) * th->nmax);
+  if (th->batch == NULL) {
+    printf("therm_init: node%d can't malloc batch\n", this_node);
+    terminate(1);
+  }
+}
+
+void therm_free(therm_t *th) {
+  free(th->batch);
+  th->batch = NULL;
+}
+
+void therm_add(therm_t *th, double x) {
+  th->cur += x;
+  th->nin++;
+  if (th->nin < THERM_BATCH || th->n >= th->nmax)
+    return;
+  th->batch[th->n++] = th->cur / (double)THERM_BATCH;
+  th->nin = 0;
+  th->cur = 0.0;
+}
+
+// MSER truncation point d, in values, minimizing the squared error of
+// the mean of the batches after d,
+//   z(d) = sum_{k >= d} (b_k - m_d)^2 / (n - d)^2
+// over the first three quarters of the n batches, where the tail is not
+// too short to judge
+// Returns -1 until there are THERM_MIN_BATCHES batches, and while the
+// minimum lies in the second half, meaning the drift is still visible
+int therm_mser(therm_t *th) {
+  register int d;
+  int n = th->n, best = 0;
+  double S1 = 0.0, S2 = 0.0, m, z, zmin = -1.0;
+
+  if (n < THERM_MIN_BATCHES)
+    return -1;
+  for (d = n - 1; d >= 0; d--) {
+    S1 += th->batch[d];
+    S2 += th->batch[d] * th->batch[d];
+    if (4 * d > 3 * n)
+      continue;
+    m = (double)(n - d);
+    z = (S2 - S1 * S1 / m) / (m * m);
+    if (zmin < 0.0 || z <= zmin) {
+      zmin = z;
+      best = d;
+    }
+  }
+  if (2 * best > n)
+    return -1;
+  return best * THERM_BATCH;
+}
+// -----------------------------------------------------------------
@@ -0,0 +1,119 @@
+// -----------------------------------------------------------------
+// Named kernel timers with call counts and flop/byte estimates
+// Only active when compiled with TIMING (see defines.h),
+// otherwise the TIC and TOC macros in macros.h expand to nothing
+
+// Each timer accumulates over the current trajectory and over the run
+// Reports reduce across nodes: time is the maximum over nodes,
+// while flops and bytes are summed over nodes
+#include "bQM_includes.h"
+
+#ifdef TIMING
+static char *timer_name[N_TIMERS] = {"update_u", "bosonic_force",
+                                     "reunitarize", "reantihermize",
+                                     "ranmom", "action", "ploop_eig",
+                                     "scalar_gibbs", "scalar_heatbath",
+                                     "link_metropolis", "scalar_eig",
+                                     "measure", "correlators", "ploop_bias",
+                                     "gather", "reduction"};
+
+// Communication timers, counted in the comm fraction
+static int timer_comm[N_TIMERS] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                    0, 0, 1, 1};
+
+static double t_start[N_TIMERS];
+static double t_time[N_TIMERS], t_flops[N_TIMERS], t_bytes[N_TIMERS];
+static double r_time[N_TIMERS], r_flops[N_TIMERS], r_bytes[N_TIMERS];
+static long t_calls[N_TIMERS], r_calls[N_TIMERS];
+static double traj_wall = -1.0, run_wall = 0.0;
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+void timer_start(int id) {
+  t_start[id] = dclock();
+}
+
+void timer_stop(int id, double flops, double bytes) {
+  t_time[id] += dclock() - t_start[id];
+  t_flops[id] += flops;
+  t_bytes[id] += bytes;
+  t_calls[id]++;
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Reduce across nodes and print one line per timer
+// Format: TAG name calls seconds GFLOP/s GB/s fraction_of_wall
+static void print_timers(char *tag, double *time, double *flops,
+                         double *bytes, long *calls, double wall) {
+  int id;
+  double t, f, b, comm = 0.0;
+
+  g_doublemax(&wall);
+  for (id = 0; id < N_TIMERS; id++) {
+    t = time[id];
+    f = flops[id];
+    b = bytes[id];
+    g_doublemax(&t);
+    g_doublesum(&f);
+    g_doublesum(&b);
+    if (timer_comm[id])
+      comm += t;
+    if (calls[id] == 0)
+      continue;
+    node0_printf("%s %-14s %8ld %10.4g %8.3g %8.3g %6.3f\n", tag,
+                 timer_name[id], calls[id], t,
+                 (t > 0.0 ? 1.0e-9 * f / t : 0.0),
+                 (t > 0.0 ? 1.0e-9 * b / t : 0.0),
+                 (wall > 0.0 ? t / wall : 0.0));
+  }
+  node0_printf("%s wall %.4g comm_fraction %.4f\n", tag, wall,
+               (wall > 0.0 ? comm / wall : 0.0));
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Call once per trajectory: fold the trajectory counters into the
+// run totals, optionally printing the trajectory breakdown first
+void timer_traj_report(int print) {
+  int id;
+  double now = dclock(), wall;
+
+  if (traj_wall < 0.0) {   // First call just starts the clocks
+    traj_wall = now;
+    run_wall = now;
+    return;
+  }
+  wall = now - traj_wall;
+  if (print)
+    print_timers("TIMING_TRAJ", t_time, t_flops, t_bytes, t_calls, wall);
+
+  for (id = 0; id < N_TIMERS; id++) {
+    r_time[id] += t_time[id];
+    r_flops[id] += t_flops[id];
+    r_bytes[id] += t_bytes[id];
+    r_calls[id] += t_calls[id];
+    t_time[id] = 0.0;
+    t_flops[id] = 0.0;
+    t_bytes[id] = 0.0;
+    t_calls[id] = 0;
+  }
+  traj_wall = now;
+}
+
+// End-of-run breakdown, including anything since the last trajectory
+void timer_final_report() {
+  timer_traj_report(0);
+  node0_printf("TIMING_RUN %-14s %8s %10s %8s %8s %6s\n", "kernel", "calls",
+               "seconds", "GFLOP/s", "GB/s", "frac");
+  print_timers("TIMING_RUN", r_time, r_flops, r_bytes, r_calls,
+               dclock() - run_wall);
+}
+#endif
+// -----------------------------------------------------------------
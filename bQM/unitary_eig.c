@@ -0,0 +1,274 @@
+// -----------------------------------------------------------------
+// Eigenvalues of a unitary NCOLxNCOL matrix, and their phases relative
+// to the circular mean, for the Polyakov loop
+// NCOL = 2 and 3 use closed forms for the roots of the characteristic
+// polynomial, and larger NCOL a cyclic Jacobi-like iteration: each step
+// is the 2x2 complex Schur rotation that zeroes U[q][p], and since
+// unitary similarity keeps U normal, its Schur form is diagonal
+// All eigenvalues are projected back onto the unit circle
+// Everything is on the stack, with no calls to LAPACK
+#include "bQM_includes.h"
+
+// Size of off-diagonal elements left after the iteration,
+// and the maximum number of sweeps
+#if (PRECISION == 1)
+#define UNITARY_TOL 1.0e-7
+#else
+#define UNITARY_TOL 1.0e-15
+#endif
+#define UNITARY_MAX_SWEEPS 50
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Move each eigenvalue onto the unit circle
+static void unit_normalize(complex *e) {
+  register int a;
+  double mag;
+
+  for (a = 0; a < NCOL; a++) {
+    mag = cabs(&(e[a]));
+    if (mag > 0.0)
+      CDIVREAL(e[a], mag, e[a]);
+  }
+}
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+#if (NCOL_PP == 2)
+// (a + d) / 2 +/- sqrt[((a - d) / 2)^2 + b c]
+void unitary_eigs(matrix *U, complex *e) {
+  complex mid, h, r, tc;
+
+  CADD(U->e[0][0], U->e[1][1], mid);
+  CMULREAL(mid, 0.5, mid);
+  CSUB(U->e[0][0], U->e[1][1], h);
+  CMULREAL(h, 0.5, h);
+  CMUL(h, h, r);
+  CMUL(U->e[0][1], U->e[1][0], tc);
+  CSUM(r, tc);
+  r = csqrt(&r);
+  CADD(mid, r, e[0]);
+  CSUB(mid, r, e[1]);
+  unit_normalize(e);
+}
+#endif
+
+#if (NCOL_PP == 3)
+// Cardano's formula in terms of the traceless B = U - Tr[U] / 3,
+// whose eigenvalues x solve x^3 + p x + q = 0 with
+//   p = -Tr[B^2] / 2,  q = -det[B]
+// Working with B rather than the coefficients of the characteristic
+// polynomial of U avoids cancellations when the eigenvalues are close
+// The roots are x_k = w^k u - w^{-k} p / (3 u) with w = exp(2 pi i / 3)
+// and u^3 = -q / 2 +/- sqrt(q^2 / 4 + p^3 / 27), taking the sign that
+// maximizes |u|, and each is polished by one Newton step
+void unitary_eigs(matrix *U, complex *e) {
+  register int a, b, k;
+  double mag, arg;
+  complex tr, p, q, s, u, v, w, f, df, tc, tc2;
+  matrix B;
+
+  tr = trace(U);
+  CMULREAL(tr, 1.0 / 3.0, tr);
+  mat_copy(U, &B);
+  for (a = 0; a < NCOL; a++)
+    CDIF(B.e[a][a], tr);
+
+  // p = -Tr[B^2] / 2
+  p = cmplx(0.0, 0.0);
+  for (a = 0; a < NCOL; a++) {
+    for (b = 0; b < NCOL; b++)
+      CMULDIF(B.e[a][b], B.e[b][a], p);
+  }
+  CMULREAL(p, 0.5, p);
+
+  // q = -det[B] by expanding along the first row
+  CMUL(B.e[1][1], B.e[2][2], tc);
+  CMULDIF(B.e[1][2], B.e[2][1], tc);
+  CMUL(B.e[0][0], tc, q);
+  CMUL(B.e[1][0], B.e[2][2], tc);
+  CMULDIF(B.e[1][2], B.e[2][0], tc);
+  CMULDIF(B.e[0][1], tc, q);
+  CMUL(B.e[1][0], B.e[2][1], tc);
+  CMULDIF(B.e[1][1], B.e[2][0], tc);
+  CMULSUM(B.e[0][2], tc, q);
+  CNEGATE(q, q);
+
+  // s = sqrt(q^2 / 4 + p^3 / 27), u^3 = -q / 2 +/- s
+  CMUL(q, q, tc);
+  CMULREAL(tc, 0.25, s);
+  CMUL(p, p, tc);
+  CMUL(tc, p, tc2);
+  CMULREAL(tc2, 1.0 / 27.0, tc2);
+  CSUM(s, tc2);
+  s = csqrt(&s);
+  CMULREAL(q, -0.5, tc);
+  if (s.real * tc.real + s.imag * tc.imag >= 0.0) {
+    CADD(tc, s, w);
+  }
+  else {
+    CSUB(tc, s, w);
+  }
+  mag = cbrt(cabs(&w));
+  arg = carg(&w) / 3.0;
+  u = cmplx(mag * cos(arg), mag * sin(arg));
+
+  w = ce_itheta(2.0 * PI / 3.0);
+  for (k = 0; k < NCOL; k++) {
+    if (mag > 0.0) {
+      // v = -p / (3 u) is the partner of u
+      CDIV(p, u, v);
+      CMULREAL(v, -1.0 / 3.0, v);
+      CADD(u, v, e[k]);
+    }
+    else
+      e[k] = cmplx(0.0, 0.0);
+    CMUL(u, w, tc);
+    u = tc;
+  }
+
+  // Newton step f / f' with f = x^3 + p x + q,
+  // skipped near multiple roots where f' vanishes
+  for (k = 0; k < NCOL; k++) {
+    CMUL(e[k], e[k], tc);
+    CADD(tc, p, tc2);
+    CMUL(tc2, e[k], f);
+    CSUM(f, q);
+    CMULREAL(tc, 3.0, df);
+    CSUM(df, p);
+    if (cabs_sq(&df) > UNITARY_TOL * cabs_sq(&p)) {
+      CDIV(f, df, tc);
+      CDIF(e[k], tc);
+    }
+    CSUM(e[k], tr);
+  }
+  unit_normalize(e);
+}
+#endif
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+#if (NCOL_PP > 3)
+// Unitary rotation in the (p, q) plane taking U -> Gdag U G, with
+// first column of G the eigenvector (z, c) of the 2x2 block
+//   [a  b]
+//   [c  d]
+// for the eigenvalue lambda = d + z, z = (a - d) / 2 +/- sqrt[...],
+// which zeroes U[q][p]
+// Returns 1 if a rotation was done, and 0 if U[q][p] is already
+// below UNITARY_TOL
+// Only the lower triangle is tested: once it vanishes, normality
+// forces the upper triangle to vanish too, up to roundoff
+static int schur_rotate(matrix *U, int p, int q) {
+  register int k;
+  double norm;
+  complex h, r, z, v1, v2, tc, tc2, ukp, ukq;
+
+  if (cabs_sq(&(U->e[q][p])) <= UNITARY_TOL * UNITARY_TOL)
+    return 0;
+
+  CSUB(U->e[p][p], U->e[q][q], h);
+  CMULREAL(h, 0.5, h);
+  CMUL(h, h, r);
+  CMUL(U->e[p][q], U->e[q][p], tc);
+  CSUM(r, tc);
+  r = csqrt(&r);
+  if (h.real * r.real + h.imag * r.imag >= 0.0) {
+    CADD(h, r, z);
+  }
+  else {
+    CSUB(h, r, z);
+  }
+  norm = sqrt(cabs_sq(&z) + cabs_sq(&(U->e[q][p])));
+  if (norm == 0.0)
+    return 0;
+  CDIVREAL(z, norm, v1);
+  CDIVREAL(U->e[q][p], norm, v2);
+
+  // Columns: U[k][p] v1 + U[k][q] v2 and -U[k][p] v2^* + U[k][q] v1^*
+  for (k = 0; k < NCOL; k++) {
+    ukp = U->e[k][p];
+    ukq = U->e[k][q];
+    CMUL(ukp, v1, tc);
+    CMUL(ukq, v2, tc2);
+    CADD(tc, tc2, U->e[k][p]);
+    CMUL_J(ukq, v1, tc);
+    CMUL_J(ukp, v2, tc2);
+    CSUB(tc, tc2, U->e[k][q]);
+  }
+  // Rows: v1^* U[p][k] + v2^* U[q][k] and -v2 U[p][k] + v1 U[q][k]
+  for (k = 0; k < NCOL; k++) {
+    ukp = U->e[p][k];
+    ukq = U->e[q][k];
+    CMULJ_(v1, ukp, tc);
+    CMULJ_(v2, ukq, tc2);
+    CADD(tc, tc2, U->e[p][k]);
+    CMUL(v1, ukq, tc);
+    CMUL(v2, ukp, tc2);
+    CSUB(tc, tc2, U->e[q][k]);
+  }
+  U->e[q][p] = cmplx(0.0, 0.0);
+  return 1;
+}
+
+// Sweep over all (p, q) until every off-diagonal element is negligible
+// U is overwritten
+void unitary_eigs(matrix *U, complex *e) {
+  register int a, p, q;
+  int sweep, rotated = 1;
+
+  for (sweep = 0; rotated && sweep < UNITARY_MAX_SWEEPS; sweep++) {
+    rotated = 0;
+    for (p = 0; p < NCOL; p++) {
+      for (q = p + 1; q < NCOL; q++)
+        rotated += schur_rotate(U, p, q);
+    }
+  }
+  if (rotated)
+    printf("unitary_eigs: no convergence after %d sweeps\n", sweep);
+
+  for (a = 0; a < NCOL; a++)
+    e[a] = U->e[a][a];
+  unit_normalize(e);
+}
+#endif
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// Phases of the eigenvalues e relative to their circular mean
+// https://en.wikipedia.org/wiki/Mean_of_circular_quantities
+// in [-pi, pi], sorted into ascending order
+void centre_phases(complex *e, double *phases) {
+  register int a, b;
+  double mag, td;
+  complex ave = cmplx(0.0, 0.0), tc;
+
+  // Make sure phases haven't all canceled out
+  // (No need to average ave by NCOL---doesn't affect phase)
+  for (a = 0; a < NCOL; a++)
+    CSUM(ave, e[a]);
+  mag = cabs(&ave);
+  if (fabs(mag) < IMAG_TOL) {
+    printf("ERROR: phases cancelled out, can't average\n");
+    fflush(stdout);
+    terminate(1);
+  }
+
+  // e ave^* has the phase of e relative to the mean
+  for (a = 0; a < NCOL; a++) {
+    CMUL_J(e[a], ave, tc);
+    td = carg(&tc);
+    for (b = a; b > 0 && phases[b - 1] > td; b--)
+      phases[b] = phases[b - 1];
+    phases[b] = td;
+  }
+}
+// -----------------------------------------------------------------
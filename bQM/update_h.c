@@ -9,17 +9,23 @@
 
 // -----------------------------------------------------------------
 // Update mom with the bosonic force
+// gemm_util.c replaces this with a BLAS version for GEMM_KERNELS,
+// and mixed_md.c with a single-precision one for MIXED_MD
+#if !defined(GEMM_KERNELS) && !defined(MIXED_MD)
 double bosonic_force(Real eps) {
   register int i, j;
   register site *s;
   Real tr;
   double returnit = 0.0;
   matrix tmat, tmat2;
-  msg_tag *tag[NSCALAR], *tag2[NSCALAR];
-//#ifdef DEBUG_CHECK
-  anti_hermitmat tah;
-//#endif
+  msg_tag *tag[NSCALAR];
+#ifndef FIXED_SCALARS
+  Real tr2;
+  anti_hermitmat f_X;
+  msg_tag *tag2[NSCALAR];
+#endif
 
+  TIC(T_FORCE)
   // Clear the gauge force collectors
   FORALLSITES(i, s)
     clear_mat(&(s->f_U));
@@ -28,27 +34,37 @@ double bosonic_force(Real eps) {
   // Must transform as site variable so momenta can be exponentiated
   //   U(n) d/dU(n) Tr[2 U(t) X(t+1) Udag(t) X(t) - X(t+1) X(t+1) - X(t) X(t)]
   //     = 2 delta_{nt} U(n) X(t+1) Udag(t) X(t) = 2 U(n) X(n+1) Udag(n) X(n)
-  for (j = 0; j < NSCALAR; j++) {
-    tag[j] = start_gather_site(F_OFFSET(X[j]), sizeof(matrix),
+  // The compressed scalars are gathered, then uncompressed for the products
+  for (j = 0; j < nscalar; j++) {
+    tag[j] = start_gather_field(X[j], sizeof(anti_hermitmat),
                                TUP, EVENANDODD, gen_pt[j]);
   }
 
-  for (j = 0; j < NSCALAR; j++) {
-    // For scalar force term, compute and gather Udag(n-1) X(n-1) U(n-1)
+#ifndef FIXED_SCALARS
+  for (j = 0; j < nscalar; j++) {
+    // For scalar force term, compute and gather Udag(n-1) X(n-1) U(n-1),
+    // which is anti-hermitian so can be gathered compressed
     FORALLSITES(i, s) {
-      mult_nn(&(s->X[j]), &(s->link), &tmat);
-      mult_an(&(s->link), &tmat, &(temp_X[j][i]));
+      uncompress_anti_hermitian(&(X[j][i]), &tmat2);
+      mult_nn(&tmat2, &(links[i]), &tmat);
+      mult_an(&(links[i]), &tmat, &tmat2);
+      compress_anti_hermitian(&tmat2, &(temp_X[j][i]));
     }
-    tag2[j] = start_gather_field(temp_X[j], sizeof(matrix),
+    tag2[j] = start_gather_field(temp_X[j], sizeof(anti_hermitmat),
                                  TDOWN, EVENANDODD, gen_pt[NSCALAR + j]);
   }
+#endif
 
-  for (j = 0; j < NSCALAR; j++) {   // X(n+1) = gen_pt[j]
+  for (j = 0; j < nscalar; j++) {   // X(n+1) = gen_pt[j]
+    TIC(T_GATHER)
     wait_gather(tag[j]);
+    TOC(T_GATHER, 0.0, GATHER_AH_BYTES)
     FORALLSITES(i, s) {
-      mult_na((matrix *)(gen_pt[j][i]), &(s->link), &tmat);
-      mult_nn(&(s->link), &tmat, &tmat2);
-      mult_nn_sum(&(s->X[j]), &tmat2, &(s->f_U));
+      uncompress_anti_hermitian((anti_hermitmat *)(gen_pt[j][i]), &tmat);
+      mult_na(&tmat, &(links[i]), &tmat2);
+      mult_nn(&(links[i]), &tmat2, &tmat);
+      uncompress_anti_hermitian(&(X[j][i]), &tmat2);
+      mult_nn_sum(&tmat2, &tmat, &(s->f_U));
     }
   }
 
@@ -57,6 +73,13 @@ double bosonic_force(Real eps) {
   // Include overall factor of 2
   // !!! Another factor of 2 needed for conservation (real vs. complex?)...
   // Compute average gauge force in same loop
+#ifdef STATIC_GAUGE
+  // Only the eigenphases feel the gauge force
+  // Already summed over nodes, so count it on one node
+  tr = static_gauge_force(eps);
+  if (this_node == 0)
+    returnit += tr;
+#else
   tr = 4.0 * eps * beta; // !!!
   FORALLSITES(i, s) {
     uncompress_anti_hermitian(&(s->mom), &tmat);
@@ -64,50 +87,58 @@ double bosonic_force(Real eps) {
     make_anti_hermitian(&tmat, &(s->mom));
     returnit += 16.0 * realtrace(&(s->f_U), &(s->f_U));
   }
+#endif
 
+#ifdef FIXED_SCALARS
+  // No scalar force: the scalars are updated between trajectories
+  for (j = 0; j < nscalar; j++)
+    cleanup_gather(tag[j]);
+#else
   // The simple pure scalar stuff:
   //   d/dX_i(n) -(2+omega^2) X_j(t)^2 = -2(2+omega^2) X_i(n)
   // Also the hopping term scalar derivative
   //   d/dX(n) 2Tr[X(t) U(t) X(t+1) Udag(t)]
   //     = 2 [delta_{nt} U(t) X(t+1) Udag(t) + delta_{n(t+1)} Udag(t) X(t) U(t)]
   //     = 2 [U(n) X(n+1) Udag(n) + Udag(n-1) X(n-1) U(n-1)]
+  // The force f_X is built compressed and added straight to the momenta
+  // Absorb overall factor of 2 in tr2
+  // Compute average scalar force in same loop (combine with gauge from above)
   tr = -2.0 - omega * omega;
-  for (j = 0; j < NSCALAR; j++) {
+  tr2 = 2.0 * eps * beta;
+  for (j = 0; j < nscalar; j++) {
+    TIC(T_GATHER)
     wait_gather(tag2[j]);
+    TOC(T_GATHER, 0.0, GATHER_AH_BYTES)
     FORALLSITES(i, s) {
-      // Initialize force with on-site -(2+omega^2) X_i(n)
-      scalar_mult_matrix(&(s->X[j]), tr, &(s->f_X[j]));
-
-      // Add forward hopping term using X(n+1) = gen_pt[j]
-      mult_na((matrix *)(gen_pt[j][i]), &(s->link), &tmat);
-      mult_nn_sum(&(s->link), &tmat, &(s->f_X[j]));
+      // Forward hopping term using X(n+1) = gen_pt[j]
+      // Projecting it also makes f_X traceless anti-hermitian
+      uncompress_anti_hermitian((anti_hermitmat *)(gen_pt[j][i]), &tmat);
+      mult_na(&tmat, &(links[i]), &tmat2);
+      mult_nn(&(links[i]), &tmat2, &tmat);
+      make_anti_hermitian(&tmat, &f_X);
 
-      // Add backward hopping term
+      // Add on-site -(2+omega^2) X_i(n) and backward hopping term
       //   Udag(n-1) X(n-1) U(n-1) = gen_pt[NSCALAR + j]
-      sum_matrix((matrix *)(gen_pt[NSCALAR + j][i]), &(s->f_X[j]));
+      // The on-site term is integrated exactly for HARMONIC_SPLIT
+#ifndef HARMONIC_SPLIT
+      scalar_mult_sum_ahmat(&(X[j][i]), tr, &f_X);
+#endif
+      scalar_mult_sum_ahmat((anti_hermitmat *)(gen_pt[NSCALAR + j][i]), 1.0,
+                            &f_X);
+
+      scalar_mult_sum_ahmat(&f_X, tr2, &(s->mom_X[j]));
+      returnit += 4.0 * realtrace_ahmat(&f_X, &f_X);
     }
     cleanup_gather(tag[j]);
     cleanup_gather(tag2[j]);
   }
-
-  // Take adjoint and update the scalar momenta
-  // Subtract to reproduce -Adj(f_X)
-  // Absorb overall factor of 2 above
-  // Compute average scalar force in same loop (combine with gauge from above)
-  tr = 2.0 * eps * beta;
-  FORALLSITES(i, s) {
-    for (j = 0; j < NSCALAR; j++) {
-//#ifdef DEBUG_CHECK
-      // Make f_X traceless anti-hermitian, which it should be already
-      make_anti_hermitian(&(s->f_X[j]), &tah);
-      uncompress_anti_hermitian(&tah, &(s->f_X[j]));
-//#endif
-      scalar_mult_sum_matrix(&(s->f_X[j]), tr, &(s->mom_X[j]));
-      returnit += 4.0 * realtrace(&(s->f_X[j]), &(s->f_X[j]));
-    }
-  }
+#endif
+  TIC(T_REDUCE)
   g_doublesum(&returnit);
+  TOC(T_REDUCE, 0.0, REDUCE_BYTES)
 
+  TOC(T_FORCE, sites_on_node * FORCE_FLOPS, sites_on_node * FORCE_BYTES)
   return (eps * beta * sqrt(returnit) / (double)nt);
 }
+#endif
 // -----------------------------------------------------------------
@@ -14,11 +14,15 @@
 
 
 // -----------------------------------------------------------------
+// static_gauge.c has its own update_u() for STATIC_GAUGE,
+// and mixed_md.c a single-precision one for MIXED_MD
+#if !defined(STATIC_GAUGE) && !defined(MIXED_MD)
 void update_u(Real eps) {
   register int i, j;
   register site *s;
   register Real t2, t3, t4, t5, t6, t7, t8;
-  matrix tmat, tmat2, tmp_mom;
+  matrix tmat, tmat2, tmp_mom, *dest_link;
+  int buf = update_target();
 
   // Calculate newU = exp(p).U
   // Go to eighth order in the exponential:
@@ -33,36 +37,45 @@ void update_u(Real eps) {
   t7 = eps / 7.0;
   t8 = eps / 8.0;
 
+  // Write into the proposal buffer at the start of a trajectory
+  dest_link = link_buf[buf];
+  TIC(T_UPDATE_U)
   FORALLSITES(i, s) {
     uncompress_anti_hermitian(&(s->mom), &tmp_mom);
-    mult_nn(&tmp_mom, &(s->link), &tmat);
-    scalar_mult_add_matrix(&(s->link), &tmat, t8, &tmat2);
+    mult_nn(&tmp_mom, &(links[i]), &tmat);
+    scalar_mult_add_matrix(&(links[i]), &tmat, t8, &tmat2);
 
     mult_nn(&tmp_mom, &tmat2, &tmat);
-    scalar_mult_add_matrix(&(s->link), &tmat, t7, &tmat2);
+    scalar_mult_add_matrix(&(links[i]), &tmat, t7, &tmat2);
 
     mult_nn(&tmp_mom, &tmat2, &tmat);
-    scalar_mult_add_matrix(&(s->link), &tmat, t6, &tmat2);
+    scalar_mult_add_matrix(&(links[i]), &tmat, t6, &tmat2);
 
     mult_nn(&tmp_mom, &tmat2, &tmat);
-    scalar_mult_add_matrix(&(s->link), &tmat, t5, &tmat2);
+    scalar_mult_add_matrix(&(links[i]), &tmat, t5, &tmat2);
 
     mult_nn(&tmp_mom, &tmat2, &tmat);
-    scalar_mult_add_matrix(&(s->link), &tmat, t4, &tmat2);
+    scalar_mult_add_matrix(&(links[i]), &tmat, t4, &tmat2);
 
     mult_nn(&tmp_mom, &tmat2, &tmat);
-    scalar_mult_add_matrix(&(s->link), &tmat, t3, &tmat2);
+    scalar_mult_add_matrix(&(links[i]), &tmat, t3, &tmat2);
 
     mult_nn(&tmp_mom, &tmat2, &tmat);
-    scalar_mult_add_matrix(&(s->link), &tmat, t2, &tmat2);
+    scalar_mult_add_matrix(&(links[i]), &tmat, t2, &tmat2);
 
     mult_nn(&tmp_mom, &tmat2, &tmat);
-    scalar_mult_sum_matrix(&tmat, eps, &(s->link));
+    scalar_mult_add_matrix(&(links[i]), &tmat, eps, &(dest_link[i]));
 
-    for (j = 0; j < NSCALAR; j++)
-      scalar_mult_sum_matrix(&(s->mom_X[j]), eps, &(s->X[j]));
+    for (j = 0; j < nscalar; j++) {
+      scalar_mult_add_ahmat(&(X[j][i]), &(s->mom_X[j]), eps,
+                            &(X_buf[buf][j][i]));
+    }
   }
+  TOC(T_UPDATE_U, sites_on_node * UPDATE_U_FLOPS,
+      sites_on_node * UPDATE_U_BYTES)
+  finish_update(buf);
 }
+#endif
 // -----------------------------------------------------------------
 
 
@@ -73,6 +86,10 @@ void update_step() {
   Real eps = traj_length / (Real)nsteps, tr;
   node0_printf("eps %.4g\n", eps);
 
+#ifdef MIXED_MD
+  // Run the trajectory on single-precision copies, see mixed_md.c
+  mixed_md_begin();
+#endif
   // First u(t/2)
   update_u(0.5 * eps);
   
@@ -80,6 +97,9 @@ void update_step() {
     //action();
     // Inner steps p(t) u(t)
     tr = bosonic_force(eps);
+#ifdef PLOOP_BIAS
+    bias_force(eps);
+#endif
     bnorm += tr;
     if (tr > max_bf)
       max_bf = tr;
@@ -89,10 +109,20 @@ void update_step() {
     else                // Final u(t/2)
       update_u(0.5 * eps);
   }
+#ifdef MIXED_MD
+  mixed_md_end();
+#endif
 
   // Reunitarize the gauge field and re-anti-hermitianize the scalars
+#ifndef STATIC_GAUGE   // Diagonal links are rebuilt exactly from theta
+  TIC(T_REUNIT)
   reunitarize();
+  TOC(T_REUNIT, sites_on_node * SVD_FLOPS, sites_on_node * 2.0 * MAT_BYTES)
+#endif
+  TIC(T_REAH)
   reantihermize();
+  TOC(T_REAH, sites_on_node * nscalar * 2.0 * NCOL,
+      sites_on_node * nscalar * 2.0 * AH_BYTES)
 }
 // -----------------------------------------------------------------
 
@@ -104,8 +134,25 @@ void update() {
   site *s;
   double startaction, endaction, change;
 
+#ifdef SCALAR_GIBBS
+  // Exact draw of the scalars, then HMC for the links alone
+  scalar_gibbs();
+#endif
+#ifdef SCALAR_HEATBATH
+  // Checkerboard heatbath and overrelaxation for the scalars,
+  // then HMC for the links alone
+  scalar_heatbath();
+#endif
+#ifdef LINK_METROPOLIS
+  // Local SU(2) subgroup updates of the links before the trajectory
+  link_metropolis();
+#endif
   // Refresh the momenta
+#ifdef GHMC
+  partial_ranmom();
+#else
   ranmom();
+#endif
 
   // Find initial action
   startaction = action();
@@ -114,8 +161,8 @@ void update() {
 
 #ifdef HMC_ALGORITHM
   Real xrandom;   // For accept/reject test
-  // Copy link field to old_link
-  copy_bosons(PLUS);
+  // Have the integrator write into the proposal buffer
+  begin_proposal();
 #endif
   // Do microcanonical updating
   update_step();
@@ -137,18 +184,21 @@ void update() {
     change = 1.0e20;
   }
 
-  // Decide whether to accept, if not, copy old link field back
+  // Decide whether to accept, if not, go back to the old fields
   // Careful -- must generate only one random number for whole lattice
   if (this_node == 0)
     xrandom = myrand(&node_prn);
   broadcast_float(&xrandom);
   if (exp(-change) < (double)xrandom) {
-    if (traj_length > 0.0)
-      copy_bosons(MINUS);
+    end_proposal(0);
+#ifdef GHMC
+    flip_mom();
+#endif
     node0_printf("REJECT: delta S = %.4g start S = %.12g end S = %.12g\n",
                  change, startaction, endaction);
   }
   else {
+    end_proposal(1);
     node0_printf("ACCEPT: delta S = %.4g start S = %.12g end S = %.12g\n",
                  change, startaction, endaction);
   }
@@ -161,5 +211,9 @@ void update() {
     node0_printf("MONITOR_FORCE %.4g %.4g\n",
                  bnorm / (double)(2 * nsteps), max_bf);
   }
+#ifdef PLOOP_BIAS
+  // Weight of the new configuration, and the next metadynamics hill
+  bias_update();
+#endif
 }
 // -----------------------------------------------------------------
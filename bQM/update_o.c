@@ -16,11 +16,54 @@
 
 
 // -----------------------------------------------------------------
+// With HARMONIC_SPLIT the on-site mass term is left out of the scalar
+// force and integrated exactly instead: on its own it gives
+//   d^2 X / dt^2 = -Omega^2 X,  Omega^2 = 2 beta (2+omega^2)
+// (see the normalization of the force in update_h.c), so a step eps
+// rotates each component of (X, mom_X / Omega) by the angle Omega eps
+// The Omelyan steps then only see the hopping force, which no longer
+// limits the step size at large omega
+#ifdef HARMONIC_SPLIT
+static void harmonic_rotate(anti_hermitmat *x, anti_hermitmat *p,
+                            Real c, Real sn, Real Om, anti_hermitmat *dest) {
+  register int k;
+  Real x0, p0;
+
+  for (k = 0; k < N_OFFDIAG; k++) {
+    x0 = x->m[k].real;
+    p0 = p->m[k].real;
+    dest->m[k].real = c * x0 + sn * p0 / Om;
+    p->m[k].real = c * p0 - sn * Om * x0;
+    x0 = x->m[k].imag;
+    p0 = p->m[k].imag;
+    dest->m[k].imag = c * x0 + sn * p0 / Om;
+    p->m[k].imag = c * p0 - sn * Om * x0;
+  }
+  for (k = 0; k < NCOL; k++) {
+    x0 = x->im_diag[k];
+    p0 = p->im_diag[k];
+    dest->im_diag[k] = c * x0 + sn * p0 / Om;
+    p->im_diag[k] = c * p0 - sn * Om * x0;
+  }
+}
+#endif
+// -----------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------
+// static_gauge.c has its own update_u() for STATIC_GAUGE
+#ifndef STATIC_GAUGE
 void update_u(Real eps) {
   register int i, j;
   register site *s;
   register Real t2, t3, t4, t5, t6, t7, t8;
-  matrix tmat, tmat2, tmp_mom;
+  matrix tmat, tmat2, tmp_mom, *dest_link;
+  int buf = update_target();
+#ifdef HARMONIC_SPLIT
+  Real Om = sqrt(2.0 * beta * (2.0 + omega * omega));
+  Real c = cos(Om * eps), sn = sin(Om * eps);
+#endif
 
   // Calculate newU = exp(p).U
   // Go to eighth order in the exponential:
@@ -35,41 +78,65 @@ void update_u(Real eps) {
   t7 = eps / 7.0;
   t8 = eps / 8.0;
 
+  // Write into the proposal buffer at the start of a trajectory
+  dest_link = link_buf[buf];
+  TIC(T_UPDATE_U)
   FORALLSITES(i, s) {
     uncompress_anti_hermitian(&(s->mom), &tmp_mom);
-    mult_nn(&tmp_mom, &(s->link), &tmat);
-    scalar_mult_add_matrix(&(s->link), &tmat, t8, &tmat2);
+    mult_nn(&tmp_mom, &(links[i]), &tmat);
+    scalar_mult_add_matrix(&(links[i]), &tmat, t8, &tmat2);
 
     mult_nn(&tmp_mom, &tmat2, &tmat);
-    scalar_mult_add_matrix(&(s->link), &tmat, t7, &tmat2);
+    scalar_mult_add_matrix(&(links[i]), &tmat, t7, &tmat2);
 
     mult_nn(&tmp_mom, &tmat2, &tmat);
-    scalar_mult_add_matrix(&(s->link), &tmat, t6, &tmat2);
+    scalar_mult_add_matrix(&(links[i]), &tmat, t6, &tmat2);
 
     mult_nn(&tmp_mom, &tmat2, &tmat);
-    scalar_mult_add_matrix(&(s->link), &tmat, t5, &tmat2);
+    scalar_mult_add_matrix(&(links[i]), &tmat, t5, &tmat2);
 
     mult_nn(&tmp_mom, &tmat2, &tmat);
-    scalar_mult_add_matrix(&(s->link), &tmat, t4, &tmat2);
+    scalar_mult_add_matrix(&(links[i]), &tmat, t4, &tmat2);
 
     mult_nn(&tmp_mom, &tmat2, &tmat);
-    scalar_mult_add_matrix(&(s->link), &tmat, t3, &tmat2);
+    scalar_mult_add_matrix(&(links[i]), &tmat, t3, &tmat2);
 
     mult_nn(&tmp_mom, &tmat2, &tmat);
-    scalar_mult_add_matrix(&(s->link), &tmat, t2, &tmat2);
+    scalar_mult_add_matrix(&(links[i]), &tmat, t2, &tmat2);
 
     mult_nn(&tmp_mom, &tmat2, &tmat);
-    scalar_mult_sum_matrix(&tmat, eps, &(s->link));
+    scalar_mult_add_matrix(&(links[i]), &tmat, eps, &(dest_link[i]));
 
-    for (j = 0; j < NSCALAR; j++)
-      scalar_mult_sum_matrix(&(s->mom_X[j]), eps, &(s->X[j]));
+    for (j = 0; j < nscalar; j++) {
+#ifdef HARMONIC_SPLIT
+      harmonic_rotate(&(X[j][i]), &(s->mom_X[j]), c, sn, Om,
+                      &(X_buf[buf][j][i]));
+#else
+      scalar_mult_add_ahmat(&(X[j][i]), &(s->mom_X[j]), eps,
+                            &(X_buf[buf][j][i]));
+#endif
+    }
   }
+  TOC(T_UPDATE_U, sites_on_node * UPDATE_U_FLOPS,
+      sites_on_node * UPDATE_U_BYTES)
+  finish_update(buf);
 }
+#endif
 // -----------------------------------------------------------------
 
 
 
 // -----------------------------------------------------------------
+// One force evaluation with coefficient c, keeping the largest
+// eps |F| in max_bf as update_leapfrog.c does for each of its steps
+static double omelyan_force(Real eps, Real c) {
+  double tr = bosonic_force(eps * c);
+
+  if (tr / c > max_bf)
+    max_bf = tr / c;
+  return tr;
+}
+
 // Omelyan version; ``dirty'' speeded-up version
 double update_bosonic_step(Real eps) {
   int n = nsteps, i;
@@ -81,16 +148,16 @@ double update_bosonic_step(Real eps) {
 #ifdef UPDATE_DEBUG
   node0_printf("gauge %d steps %.4g dt\n", n, eps);
 #endif
-  norm = bosonic_force(eps * LAMBDA);
+  norm = omelyan_force(eps, LAMBDA);
   for (i = 1; i <= n; i++) {
     update_u(0.5 * eps);
-    norm += bosonic_force(eps * LAMBDA_MID);
+    norm += omelyan_force(eps, LAMBDA_MID);
     update_u(0.5 * eps);
     if (i < n)
-      norm += bosonic_force(eps * TWO_LAMBDA);
+      norm += omelyan_force(eps, TWO_LAMBDA);
 
     else
-      norm += bosonic_force(eps * LAMBDA);
+      norm += omelyan_force(eps, LAMBDA);
   }
 
   // Reunitarize the gauge field and re-anti-hermitianize the scalars
@@ -98,8 +165,15 @@ double update_bosonic_step(Real eps) {
   td = check_unitarity();
   g_floatmax(&td);
 #endif
+#ifndef STATIC_GAUGE   // Diagonal links are rebuilt exactly from theta
+  TIC(T_REUNIT)
   reunitarize();
+  TOC(T_REUNIT, sites_on_node * SVD_FLOPS, sites_on_node * 2.0 * MAT_BYTES)
+#endif
+  TIC(T_REAH)
   reantihermize();
+  TOC(T_REAH, sites_on_node * nscalar * 2.0 * NCOL,
+      sites_on_node * nscalar * 2.0 * AH_BYTES)
 #ifdef UPDATE_DEBUG
   td2 = check_unitarity();
   g_floatmax(&td2);
@@ -114,32 +188,19 @@ double update_bosonic_step(Real eps) {
 
 
 // -----------------------------------------------------------------
+// update_bosonic_step() already takes all nsteps steps of size eps,
+// covering the full trajectory length, and sets max_bf
 void update_step() {
-  int i_multi0;
   Real eps, tr;
 
   eps = traj_length / (Real)nsteps;
+  node0_printf("eps %.4g\n", eps);
 
-  for (i_multi0 = 1; i_multi0 <= nsteps; i_multi0++) {
-    tr = update_bosonic_step(eps);
+  tr = update_bosonic_step(eps);
 #ifdef UPDATE_DEBUG
-    node0_printf("Step %d - 1 Action %.4g Force %.4g\n", i_multi0,
-                 action(), tr);
+  node0_printf("Action %.4g Force %.4g\n", action(), tr);
 #endif
-    bnorm += tr;
-    if (tr > max_bf)
-      max_bf = tr;
-
-    tr = update_bosonic_step(eps);
-#ifdef UPDATE_DEBUG
-    node0_printf("Step %d - 2 Action %.4g Force %.4g\n", i_multi0,
-                 action(), tr);
-#endif
-    bnorm += tr;
-    if (tr > max_bf)
-      max_bf = tr;
-
-  }
+  bnorm += tr;
 }
 // -----------------------------------------------------------------
 
@@ -147,11 +208,27 @@ void update_step() {
 
 // -----------------------------------------------------------------
 void update() {
-  int n;
   double startaction, endaction, change;
 
+#ifdef SCALAR_GIBBS
+  // Exact draw of the scalars, then HMC for the links alone
+  scalar_gibbs();
+#endif
+#ifdef SCALAR_HEATBATH
+  // Checkerboard heatbath and overrelaxation for the scalars,
+  // then HMC for the links alone
+  scalar_heatbath();
+#endif
+#ifdef LINK_METROPOLIS
+  // Local SU(2) subgroup updates of the links before the trajectory
+  link_metropolis();
+#endif
   // Refresh the momenta
+#ifdef GHMC
+  partial_ranmom();
+#else
   ranmom();
+#endif
 
   // Find initial action
   startaction = action();
@@ -160,8 +237,8 @@ void update() {
 
 #ifdef HMC_ALGORITHM
   Real xrandom;   // For accept/reject test
-  // Copy link field and scalars to old_link and old_X
-  copy_bosons(PLUS);
+  // Have the integrator write into the proposal buffer
+  begin_proposal();
 #endif
   // Do microcanonical updating
   update_step();
@@ -181,20 +258,21 @@ void update() {
     change = 1.0e20;
   }
 
-  // Decide whether to accept, if not, copy old link field back
+  // Decide whether to accept, if not, go back to the old fields
   // Careful -- must generate only one random number for whole lattice
   if (this_node == 0)
     xrandom = myrand(&node_prn);
   broadcast_float(&xrandom);
   if (exp(-change) < (double)xrandom) {
-    if (traj_length > 0.0) {
-      // Restore link field and scalars from old_link and old_X
-      copy_bosons(MINUS);
-    }
+    end_proposal(0);
+#ifdef GHMC
+    flip_mom();
+#endif
     node0_printf("REJECT: delta S = %.4g start S = %.12g end S = %.12g\n",
                  change, startaction, endaction);
   }
   else {
+    end_proposal(1);
     node0_printf("ACCEPT: delta S = %.4g start S = %.12g end S = %.12g\n",
                  change, startaction, endaction);
   }
@@ -204,8 +282,7 @@ void update() {
 #endif // ifdef HMC
 
   if (traj_length > 0) {
-    node0_printf("MONITOR_FORCE %.4g %.4g\n",
-                 bnorm / (double)(2.0 * nsteps), max_bf);
+    node0_printf("MONITOR_FORCE %.4g %.4g\n", bnorm, max_bf);
   }
 }
 // -----------------------------------------------------------------
@@ -10,29 +10,17 @@
 
 
 // -----------------------------------------------------------------
-Real check_ah(matrix *c) {
-  register int i, j;
-  register Real ar, ai, ari, max = 0.0;
-
-  // Check real part of diagonal entries
-  for (i = 0; i < NCOL; i++) {
-    ar = fabs((*c).e[i][i].real);
-    if (max < ar)
-      max = ar;
-  }
+Real check_ah(anti_hermitmat *c) {
+  register int i;
+  register Real tr;
 
-  // Check that off-diagonal entries are negative complex conjugates
-  for (i = 0; i < NCOL; i++) {
-    for (j = i + 1; j < NCOL; j++) {
-      ar = (*c).e[i][j].real + (*c).e[j][i].real;
-      ai = (*c).e[i][j].imag - (*c).e[j][i].imag;
-      ari = sqrt(ar * ar + ai * ai);
-      if (max < ari)
-        max = ari;
-    }
-  }
+  // Compressed storage is anti-hermitian by construction,
+  // so only check the trace of the imaginary diagonal
+  tr = c->im_diag[0];
+  for (i = 1; i < NCOL; i++)
+    tr += c->im_diag[i];
 
-  return max;
+  return fabs(tr) / (Real)NCOL;
 }
 // -----------------------------------------------------------------
 
@@ -42,19 +30,19 @@ Real check_ah(matrix *c) {
 Real check_antihermity() {
   register int i, j;
   register site *s;
-  register matrix *mat;
+  register anti_hermitmat *ah;
   Real deviation, max_deviation = 0.0;
   double av_deviation = 0.0;
 
   FORALLSITES(i, s) {
-    for (j = 0; j < NSCALAR; j++) {
-      mat = (matrix *)&(s->X[j]);
-      deviation = check_ah(mat);
+    for (j = 0; j < nscalar; j++) {
+      ah = &(X[j][i]);
+      deviation = check_ah(ah);
       if (deviation > TOLERANCE) {
         printf("Anti-hermiticity problem on node %d, site %d, ", mynode(), i);
         printf("scalar %d, deviation=%f\n", j, deviation);
         printf("Matrix:\n");
-        dumpmat(mat);
+        dump_ahmat(ah);
         fflush(stdout);
         terminate(1);
       }
@@ -64,7 +52,7 @@ Real check_antihermity() {
     }
   }
 
-  av_deviation = sqrt(av_deviation / (double)(NSCALAR * nt));
+  av_deviation = sqrt(av_deviation / (double)(nscalar * nt));
 #ifdef AHDEBUG
   printf("Deviation from anti-hermiticity on node %d: max %.4g, ave %.4g\n",
          mynode(), max_deviation, av_deviation);
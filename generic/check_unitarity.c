@@ -62,7 +62,7 @@ Real check_unitarity() {
   double av_deviation = 0.0;
 
   FORALLSITES(i, s) {
-    mat = &(s->link);
+    mat = &(links[i]);
     deviation = check_unit(mat);
     if (deviation > TOLERANCE) {
       printf("Unitarity problem on node %d, site %d, deviation=%f\n",
@@ -200,11 +200,13 @@ void err_func(MPI_Comm *comm, int *stat, ...) {
 
 // Machine initialization
 void initialize_machine(int *argc, char ***argv) {
-  int i, flag, *tag_ub;
+  int i, flag, started, *tag_ub;
   MPI_Comm comm;
   MPI_Errhandler errhandler;
 
-  flag = MPI_Init(argc, argv);
+  // bQM_hmc_multi has already started MPI to read ncol
+  MPI_Initialized(&started);
+  flag = (started ? MPI_SUCCESS : MPI_Init(argc, argv));
   comm = MPI_COMM_WORLD;
   if (flag)
     err_func(&comm, &flag);
@@ -412,6 +414,16 @@ void g_doublemax(double *dpt) {
   MPI_Allreduce(dpt, &work, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
   *dpt = work;
 }
+
+// Find maximum of each element of a vector of doubles over all nodes
+void g_vecdoublemax(double *dpt, int length) {
+  int i;
+  double *work = malloc(sizeof *work * length);
+  MPI_Allreduce(dpt, work, length, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+  for (i = 0; i < length; i++)
+    dpt[i] = work[i];
+  free(work);
+}
 // -----------------------------------------------------------------
 
 
@@ -213,6 +213,10 @@ void g_floatmax(Real *fpt) {
 // Find maximum of double over all nodes
 void g_doublemax(double *dpt) {
 }
+
+// Find maximum of each element of a vector of doubles over all nodes
+void g_vecdoublemax(double *dpt, int ndoubles) {
+}
 // -----------------------------------------------------------------
 
 
@@ -49,20 +49,23 @@ gauge_file *save_lattice(int flag, char *filename) {
 void coldlat() {
   register int i, j, k, l;
   register site *s;
-  complex i_inv_sqrt = cmplx(0.0, 1.0 / sqrt(2.0));
+  Real inv_sqrt = 1.0 / sqrt(2.0);
 
   FORALLSITES(i, s) {
     for (j = 0; j < NCOL; j++) {
-      s->link.e[j][j] = cmplx(1.0, 0.0);
+      links[i].e[j][j] = cmplx(1.0, 0.0);
       for (k = j + 1; k < NCOL; k++) {
-        s->link.e[j][k] = cmplx(0.0, 0.0);
-        s->link.e[k][j] = cmplx(0.0, 0.0);
+        links[i].e[j][k] = cmplx(0.0, 0.0);
+        links[i].e[k][j] = cmplx(0.0, 0.0);
       }
     }
-    for (l = 0; l < NSCALAR; l++) {
-      clear_mat(&(s->X[l]));
-      s->X[l].e[0][0] = i_inv_sqrt;
-      CNEGATE(s->X[l].e[0][0], s->X[l].e[1][1]);
+    for (l = 0; l < nscalar; l++) {
+      for (j = 0; j < NCOL; j++)
+        X[l][i].im_diag[j] = 0.0;
+      for (j = 0; j < N_OFFDIAG; j++)
+        X[l][i].m[j] = cmplx(0.0, 0.0);
+      X[l][i].im_diag[0] = inv_sqrt;
+      X[l][i].im_diag[1] = -inv_sqrt;
     }
   }
   node0_printf("unit gauge and anti-hermitian scalar configuration loaded\n");
@@ -76,14 +79,20 @@ void coldlat() {
 void funnylat() {
   register int i, j, k, l;
   register site *s;
+  matrix tmat;
 
+  // The scalars keep only the traceless anti-hermitian part
   FORALLSITES(i, s) {
     for (j = 0; j < NCOL; ++j) {
-      for (k = 0; k < NCOL; ++k) {
-        s->link.e[j][k] = cmplx(10.0 * j * nt, 10.0 * k * s->t);
-        for (l = 0; l < NSCALAR; l++)
-          s->X[l].e[j][k] = cmplx(10.0 * j * l, 10.0 * k * s->t);
+      for (k = 0; k < NCOL; ++k)
+        links[i].e[j][k] = cmplx(10.0 * j * nt, 10.0 * k * s->t);
+    }
+    for (l = 0; l < nscalar; l++) {
+      for (j = 0; j < NCOL; ++j) {
+        for (k = 0; k < NCOL; ++k)
+          tmat.e[j][k] = cmplx(10.0 * j * l, 10.0 * k * s->t);
       }
+      make_anti_hermitian(&tmat, &(X[l][i]));
     }
   }
 }
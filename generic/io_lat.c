@@ -24,6 +24,13 @@
 #undef MAX_BUF_LENGTH
 #define MAX_BUF_LENGTH 4096
 
+// Each site is stored as NSCALAR + 1 matrices of NCOL * NCOL
+// single-precision elements, without the padding of the NCOL_DYN types,
+// so files don't depend on how NCOL was set at compile time
+#define FMAT_SIZE (NCOL * NCOL)
+#define SITE_SIZE ((NSCALAR + 1) * FMAT_SIZE)
+#define SITE_BYTES (SITE_SIZE * sizeof(fcomplex))
+
 /* Checksums
    The dataset from which each checksum is computed is the full gauge
    configuration for lattice files and for propagator files, the
@@ -63,21 +70,21 @@
 
 
 // -----------------------------------------------------------------
-// Copy a single precision fundamental matrix to generic precision
-void f2d_mat(fmatrix *a, matrix *b) {
+// Copy FMAT_SIZE single precision elements to a generic precision matrix
+void f2d_mat(fcomplex *a, matrix *b) {
   int i, j;
   for (i = 0; i < NCOL; i++) {
     for (j = 0; j < NCOL; j++)
-      set_complex_equal(&(a->e[i][j]), &(b->e[i][j]));
+      set_complex_equal(&(a[i * NCOL + j]), &(b->e[i][j]));
   }
 }
 
-// Copy a generic precision fundamental matrix to single precision
-void d2f_mat(matrix *a, fmatrix *b) {
+// Copy a generic precision matrix to FMAT_SIZE single precision elements
+void d2f_mat(matrix *a, fcomplex *b) {
   int i, j;
   for (i = 0; i < NCOL; i++) {
     for (j = 0; j < NCOL; j++)
-      set_complex_equal(&(a->e[i][j]), &(b->e[i][j]));
+      set_complex_equal(&(a->e[i][j]), &(b[i * NCOL + j]));
   }
 }
 // -----------------------------------------------------------------
@@ -128,7 +135,7 @@ gauge_file *w_serial_i(char *filename) {
 
 // -----------------------------------------------------------------
 // Flush lbuf to output, resetting buf_length
-static void flush_lbuf_to_file(gauge_file *gf, fmatrix *lbuf,
+static void flush_lbuf_to_file(gauge_file *gf, fcomplex *lbuf,
                                int *buf_length) {
 
   FILE *fp = gf->fp;
@@ -137,7 +144,7 @@ static void flush_lbuf_to_file(gauge_file *gf, fmatrix *lbuf,
   if (*buf_length <= 0)
     return;
 
-  stat = (int)fwrite(lbuf, (NSCALAR + 1) * sizeof(fmatrix), *buf_length, fp);
+  stat = (int)fwrite(lbuf, SITE_BYTES, *buf_length, fp);
   if (stat != *buf_length) {
     printf("w_serial: node%d gauge configuration write error %d file %s\n",
            this_node, errno, gf->filename);
@@ -176,36 +183,31 @@ static void accum_cksums(gauge_file *gf, int *rank29, int *rank31,
 // -----------------------------------------------------------------
 // Flush tbuf to lbuf and accumulate checksums without resetting tbuf_length
 static void flush_tbuf_to_lbuf(gauge_file *gf, int *rank29, int *rank31,
-                               fmatrix *lbuf, int *buf_length,
-                               fmatrix *tbuf, int tbuf_length) {
+                               fcomplex *lbuf, int *buf_length,
+                               fcomplex *tbuf, int tbuf_length) {
 
   int nword;
   u_int32type *buf;
 
   if (tbuf_length > 0) {
-    memcpy((void *)&lbuf[(NSCALAR + 1) * (*buf_length)],
-           (void *)tbuf, (NSCALAR + 1) * tbuf_length * sizeof(fmatrix));
+    memcpy((void *)&lbuf[SITE_SIZE * (*buf_length)],
+           (void *)tbuf, tbuf_length * SITE_BYTES);
 
-    nword = (NSCALAR + 1) * (int)sizeof(fmatrix)
-                    / (int)sizeof(int32type) * tbuf_length;
-    buf = (u_int32type *)&lbuf[(NSCALAR + 1) * (*buf_length)];
+    nword = (int)SITE_BYTES / (int)sizeof(int32type) * tbuf_length;
+    buf = (u_int32type *)&lbuf[SITE_SIZE * (*buf_length)];
     accum_cksums(gf, rank29, rank31, buf, nword);
 
     *buf_length += tbuf_length;
   }
 }
 
-static void send_buf_to_node0(fmatrix *tbuf, int tbuf_length,
+static void send_buf_to_node0(fcomplex *tbuf, int tbuf_length,
                               int currentnode) {
 
-  if (this_node == currentnode) {
-    send_field((char *)tbuf,
-               (NSCALAR + 1) * tbuf_length * sizeof(fmatrix), 0);
-  }
-  else if (this_node == 0) {
-    get_field((char *)tbuf,
-              (NSCALAR + 1) * tbuf_length * sizeof(fmatrix), currentnode);
-  }
+  if (this_node == currentnode)
+    send_field((char *)tbuf, tbuf_length * SITE_BYTES, 0);
+  else if (this_node == 0)
+    get_field((char *)tbuf, tbuf_length * SITE_BYTES, currentnode);
 }
 // -----------------------------------------------------------------
 
@@ -219,8 +221,9 @@ void w_serial(gauge_file *gf) {
   int j, t, currentnode, newnode;
   FILE *fp = NULL;
   gauge_header *gh = NULL;
-  fmatrix *lbuf = NULL;
-  fmatrix *tbuf = malloc(sizeof *tbuf * nt * (NSCALAR + 1));
+  fcomplex *lbuf = NULL;
+  fcomplex *tbuf = malloc(sizeof *tbuf * nt * SITE_SIZE);
+  matrix tmat;
   off_t offset;               // File stream pointer
   off_t coord_list_size;      // Size of coordinate list in bytes
   off_t head_size;            // Size of header plus coordinate list
@@ -236,7 +239,7 @@ void w_serial(gauge_file *gf) {
 
   // Only allocate lbuf on node0
   if (this_node == 0) {
-    lbuf = malloc(sizeof *lbuf * MAX_BUF_LENGTH * (NSCALAR + 1));
+    lbuf = malloc(sizeof *lbuf * MAX_BUF_LENGTH * SITE_SIZE);
     if (lbuf == NULL) {
       printf("w_serial: node0 can't malloc lbuf\n");
       fflush(stdout);
@@ -271,9 +274,9 @@ void w_serial(gauge_file *gf) {
   gf->check.sum29 = 0;
   // Count 32-bit words mod 29 and mod 31 in order of appearance on file
   // Here only node 0 uses these values -- both start at 0
-  i = sizeof(fmatrix) / sizeof(int32type) * sites_on_node * this_node;
-  rank29 = ((NSCALAR + 1) * i) % 29;
-  rank31 = ((NSCALAR + 1) * i) % 31;
+  i = SITE_BYTES / sizeof(int32type) * sites_on_node * this_node;
+  rank29 = i % 29;
+  rank31 = i % 31;
 
   g_sync();
   currentnode = 0;  // The node delivering data
@@ -312,11 +315,17 @@ void w_serial(gauge_file *gf) {
     // The node with the data just appends to its tbuf
     if (this_node == currentnode) {
       i = node_index(t);
-      index = (NSCALAR + 1) * tbuf_length;
-      d2f_mat(&lattice[i].link, &tbuf[index]);
+      index = SITE_SIZE * tbuf_length;
+      d2f_mat(&links[i], &tbuf[index]);
       for (j = 0; j < NSCALAR; j++) {
-        index++;
-        d2f_mat(&lattice[i].X[j], &tbuf[index]);
+        // Files keep full matrices for all NSCALAR scalars,
+        // with zeros for those beyond nscalar
+        index += FMAT_SIZE;
+        if (j < nscalar)
+          uncompress_anti_hermitian(&X[j][i], &tmat);
+        else
+          clear_mat(&tmat);
+        d2f_mat(&tmat, &tbuf[index]);
       }
     }
 
@@ -380,8 +389,9 @@ void r_serial(gauge_file *gf) {
   gauge_check test_gc;
   u_int32type *val;
   int rank29 = 0, rank31 = 0;
-  fmatrix *lbuf = NULL;   // Only allocate on node0
-  fmatrix tmat[NSCALAR + 1];
+  fcomplex *lbuf = NULL;   // Only allocate on node0
+  fcomplex tmat[(NSCALAR + 1) * NCOL_DIM * NCOL_DIM];
+  matrix tscalar;
 
   if (this_node == 0) {
     // Compute offset for reading gauge configuration
@@ -398,7 +408,7 @@ void r_serial(gauge_file *gf) {
     head_size = checksum_offset + gauge_check_size;
 
     // Allocate single-precision read buffer
-    lbuf = malloc(sizeof *lbuf * MAX_BUF_LENGTH * (NSCALAR + 1));
+    lbuf = malloc(sizeof *lbuf * MAX_BUF_LENGTH * SITE_SIZE);
     if (lbuf == NULL) {
       printf("r_serial: node%d can't malloc lbuf\n", this_node);
       fflush(stdout);
@@ -450,7 +460,7 @@ void r_serial(gauge_file *gf) {
           buf_length = MAX_BUF_LENGTH;
 
         // Now do read
-        stat = (int)fread(lbuf, (NSCALAR + 1) * sizeof(fmatrix), buf_length, fp);
+        stat = (int)fread(lbuf, SITE_BYTES, buf_length, fp);
         if (stat != buf_length) {
           printf("r_serial: node%d gauge configuration read error %d file %s\n",
                  this_node, errno, filename);
@@ -463,12 +473,11 @@ void r_serial(gauge_file *gf) {
       if (destnode == 0) {  // Just copy links
         idest = node_index(t);
         // Save (NSCALAR + 1) matrices in tmat for further processing
-        memcpy(tmat, &lbuf[(NSCALAR + 1) * where_in_buf],
-               (NSCALAR + 1) * sizeof(fmatrix));
+        memcpy(tmat, &lbuf[SITE_SIZE * where_in_buf], SITE_BYTES);
       }
       else {                // Send to correct node
-        send_field((char *)&lbuf[(NSCALAR + 1) * where_in_buf],
-                   (NSCALAR + 1) * sizeof(fmatrix), destnode);
+        send_field((char *)&lbuf[SITE_SIZE * where_in_buf],
+                   SITE_BYTES, destnode);
       }
       where_in_buf++;
     }
@@ -478,7 +487,7 @@ void r_serial(gauge_file *gf) {
       if (this_node == destnode) {
         idest = node_index(t);
         // Receive (NSCALAR + 1) matrices in temporary space for further processing
-        get_field((char *)tmat, (NSCALAR + 1) * sizeof(fmatrix), 0);
+        get_field((char *)tmat, SITE_BYTES, 0);
       }
     }
 
@@ -487,11 +496,10 @@ void r_serial(gauge_file *gf) {
        and idest points to the destination site structure. */
     if (this_node == destnode) {
       if (byterevflag == 1)
-        byterevn((int32type *)tmat,
-                 (NSCALAR + 1) * sizeof(fmatrix) / sizeof(int32type));
+        byterevn((int32type *)tmat, SITE_BYTES / sizeof(int32type));
       // Accumulate checksums
       for (k = 0, val = (u_int32type *)tmat;
-           k < (NSCALAR + 1) * (int)sizeof(fmatrix) / (int)sizeof(int32type);
+           k < (int)SITE_BYTES / (int)sizeof(int32type);
            k++, val++) {
         test_gc.sum29 ^= (*val)<<rank29 | (*val)>>(32 - rank29);
         test_gc.sum31 ^= (*val)<<rank31 | (*val)>>(32 - rank31);
@@ -503,13 +511,17 @@ void r_serial(gauge_file *gf) {
           rank31 = 0;
       }
       // Copy (NSCALAR + 1) matrices to generic-precision lattice[idest]
-      f2d_mat(&(tmat[0]), &lattice[idest].link);
-      for (j = 0; j < NSCALAR; j++)
-        f2d_mat(&(tmat[j + 1]), &lattice[idest].X[j]);
+      // Project the scalars to compressed traceless anti-hermitian form
+      f2d_mat(tmat, &links[idest]);
+      // Scalars beyond nscalar are ignored
+      for (j = 0; j < nscalar; j++) {
+        f2d_mat(tmat + (j + 1) * FMAT_SIZE, &tscalar);
+        make_anti_hermitian(&tscalar, &X[j][idest]);
+      }
     }
     else {
-      rank29 += (NSCALAR + 1) * sizeof(fmatrix) / sizeof(int32type);
-      rank31 += (NSCALAR + 1) * sizeof(fmatrix) / sizeof(int32type);
+      rank29 += SITE_BYTES / sizeof(int32type);
+      rank31 += SITE_BYTES / sizeof(int32type);
       rank29 %= 29;
       rank31 %= 31;
     }
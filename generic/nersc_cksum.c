@@ -26,14 +26,14 @@ void sum_linktr(double_complex *linktrsum) {
   linktrsum->imag = 0.0;
 
   FORALLSITES(i, s) {
-    a = &(s->link);
+    a = &(links[i]);
     CSUM(*linktrsum, a->e[0][0]);
     CSUM(*linktrsum, a->e[1][1]);
-#if (NCOL > 2)
+#if (NCOL_PP > 2)
     CSUM(*linktrsum, a->e[2][2]);
-#if (NCOL > 3)
+#if (NCOL_PP > 3)
     CSUM(*linktrsum, a->e[3][3]);
-#if (NCOL > 4)
+#if (NCOL_PP > 4)
     int j;
     for (j = 4; j < NCOL; j++)
       CSUM(*linktrsum, a->e[j][j]);
@@ -5,9 +5,9 @@
 // 2) Reconstruct out = L.Rdag, setting vector S=(1, 1, ..., 1)
 // Both L and R are unitary NCOLxNCOL matrices
 
-// Also reanti-hermitization for arbitrary NCOL
-// 1) Zero out real parts of diagonal entries
-// 2) Make off diagonal entries negative complex conjugates
+// Also reanti-hermitization of the compressed scalars for arbitrary NCOL
+// The compressed form is anti-hermitian by construction,
+// so this just removes any trace that has built up
 #include "generic_includes.h"
 
 #define TOLERANCE 0.0001
@@ -96,7 +96,7 @@ void reunitarize() {
   av_deviation = 0.0;
 
   FORALLSITES(i, s) {
-    mat = &(s->link);
+    mat = &(links[i]);
     errors = reunit(mat);
     errcount += errors;
     if (errors) {
@@ -130,38 +130,29 @@ void reunitarize() {
 
 
 // -----------------------------------------------------------------
-int reah(matrix *c) {
+int reah(anti_hermitmat *c) {
+  register int i;
   register Real tr;
-  int i, j, errors = 0;
+  int errors;
   Real deviation;
-  matrix tmat;
-
-  mat_copy(c, &tmat);
-  for (i = 0; i < NCOL; i++) {
-    // Zero our real parts of diagonal entries
-    deviation = fabs((*c).e[i][i].real);
-    errors += check_deviation(deviation);   // Use definition in reunitarize.c
-    (*c).e[i][i].real = 0.0;
-
-    // Make off diagonal entries negative complex conjugates
-    for (j = i + 1; i < NCOL; i++) {
-      deviation = fabs((*c).e[i][j].real + (*c).e[j][i].real);
-      errors += check_deviation(deviation);
-      tr = 0.5 * ((*c).e[i][j].real - (*c).e[j][i].real);
-      (*c).e[i][j].real = tr;
-      (*c).e[j][i].real = -tr;
-
-      deviation = fabs((*c).e[i][j].imag - (*c).e[j][i].imag);
-      errors += check_deviation(deviation);
-      tr = 0.5 * ((*c).e[i][j].imag + (*c).e[j][i].imag);
-      (*c).e[i][j].imag = tr;
-      (*c).e[j][i].imag = tr;
-    }
-  }
+  anti_hermitmat tah;
+
+  // Compressed storage is anti-hermitian by construction,
+  // so only the trace of the imaginary diagonal can drift
+  tah = *c;
+  tr = c->im_diag[0];
+  for (i = 1; i < NCOL; i++)
+    tr += c->im_diag[i];
+  tr /= (Real)NCOL;
+
+  deviation = fabs(tr);
+  errors = check_deviation(deviation);   // Use definition in reunitarize.c
+  for (i = 0; i < NCOL; i++)
+    c->im_diag[i] -= tr;
 
   // Print the problematic matrix rather than the updated one
   if (errors)
-    dumpmat(&tmat);
+    dump_ahmat(&tah);
 
   return errors;
 }
@@ -173,7 +164,6 @@ int reah(matrix *c) {
 void reantihermize() {
   register int i, j;
   register site *s;
-  register matrix *mat;
   int errcount = 0, errors;
 
   // Globally defined in reunitarize.c
@@ -181,9 +171,8 @@ void reantihermize() {
   av_deviation = 0.0;
 
   FORALLSITES(i, s) {
-    for (j = 0; j < NSCALAR; j++) {
-      mat = (matrix *)&(s->X[j]);
-      errors = reah(mat);
+    for (j = 0; j < nscalar; j++) {
+      errors = reah(&(X[j][i]));
       errcount += errors;
       if (errors) {
         printf("Anti-hermiticity problem above ");
@@ -12,27 +12,50 @@
 // -----------------------------------------------------------------
 // The d=1 gauge group is SU(NCOL)
 // All matrices in adjoint rep with NADJ = NCOL^2 - 1 generators
+// NCOL may also come from the compiler, as for the *_multi targets
+// With NCOL_DYN it is instead ncol_dyn, read by setup(), for the generic
+// instance of the *_multi targets (see ../bQM/control_multi.c); the types
+// then have room for NCOL_MAX colors (8 unless given by the compiler, see
+// ../bQM/README for the memory this costs), and preprocessor tests see
+// NCOL_PP = 5, the smallest ncol left to that instance
+// Array dimensions use the *_DIM sizes, equal to NCOL etc. otherwise
+#ifdef NCOL_DYN
+extern int ncol_dyn;
+#define NCOL ncol_dyn
+#define NCOL_PP 5
+#ifndef NCOL_MAX
+#define NCOL_MAX 8
+#endif
+#define NCOL_DIM NCOL_MAX
+#else
+#ifndef NCOL
 #define NCOL 2
+#endif
+#define NCOL_PP NCOL
+#define NCOL_DIM NCOL
+#endif
 #define NADJ (NCOL * NCOL - 1)
 #define N_OFFDIAG (NCOL * (NCOL - 1) / 2)
+#define NADJ_DIM (NCOL_DIM * NCOL_DIM - 1)
+#define N_OFFDIAG_DIM (NCOL_DIM * (NCOL_DIM - 1) / 2)
 
 // Number of scalars
 #define NSCALAR 9
 
-typedef struct { fcomplex e[NCOL][NCOL]; } fmatrix;
-typedef struct { fcomplex c[NCOL]; } fvector;
+typedef struct { fcomplex e[NCOL_DIM][NCOL_DIM]; } fmatrix;
+typedef struct { fcomplex c[NCOL_DIM]; } fvector;
 
 // Anti-hermitian matrices for general NCOL
 typedef struct {
-  fcomplex m[N_OFFDIAG];
-  float im_diag[NCOL];
+  fcomplex m[N_OFFDIAG_DIM];
+  float im_diag[NCOL_DIM];
 } fanti_hermitmat;
 
-typedef struct { dcomplex e[NCOL][NCOL]; } dmatrix;
-typedef struct { dcomplex c[NCOL]; } dvector;
+typedef struct { dcomplex e[NCOL_DIM][NCOL_DIM]; } dmatrix;
+typedef struct { dcomplex c[NCOL_DIM]; } dvector;
 typedef struct {
-  dcomplex m[N_OFFDIAG];
-  double im_diag[NCOL];
+  dcomplex m[N_OFFDIAG_DIM];
+  double im_diag[NCOL_DIM];
 } danti_hermitmat;
 
 #if (PRECISION == 1)
@@ -78,6 +101,7 @@ complex trace(matrix *a);
 // In file realtr.c
 Real realtrace_nn(matrix *a, matrix *b);
 Real realtrace(matrix *a, matrix *b);
+double d_realtrace_nn(matrix *a, matrix *b);
 
 // In file complextr.c
 complex complextrace_nn(matrix *a, matrix *b);
@@ -196,6 +220,15 @@ void compress_anti_hermitian(matrix *m, anti_hermitmat *ah);
 
 // In file dump_ahmat.c
 void dump_ahmat(anti_hermitmat *ahm);
+
+// In file s_m_a_ahmat.c
+void scalar_mult_ahmat(anti_hermitmat *b, Real s, anti_hermitmat *c);
+void scalar_mult_sum_ahmat(anti_hermitmat *b, Real s, anti_hermitmat *c);
+void scalar_mult_add_ahmat(anti_hermitmat *a, anti_hermitmat *b, Real s,
+                           anti_hermitmat *c);
+
+// In file realtr_ahmat.c
+double realtrace_ahmat(anti_hermitmat *a, anti_hermitmat *b);
 // -----------------------------------------------------------------
 
 
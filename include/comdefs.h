@@ -48,6 +48,7 @@ void g_vecdcomplexsum(double_complex *cpt, int ncomplex);
 void g_xor32(u_int32type *pt );
 void g_floatmax(Real *fpt);
 void g_doublemax(double *dpt);
+void g_vecdoublemax(double *dpt, int ndoubles);
 void broadcast_float(Real *fpt);
 void broadcast_double(double *dpt);
 void broadcast_complex(complex *cpt);
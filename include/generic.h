@@ -22,7 +22,7 @@
 // check_unitarity.c and check_antihermity.c
 Real check_unit(matrix *c);
 Real check_unitarity();
-Real check_ah();
+Real check_ah(anti_hermitmat *c);
 Real check_antihermity();
 
 // io_helpers.c
@@ -67,7 +67,7 @@ void initialize_prn(double_prn *prn_pt, int seed, int index);
 Real myrand(double_prn *prn_pt);
 
 // reunitarize.c and reantihermize.c
-int check_deviation();
+int check_deviation(Real deviation);
 void reunitarize();
 void reantihermize();
 // Use LAPACK singular value decomposition for reunitarization
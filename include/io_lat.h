@@ -63,6 +63,7 @@ char *gauge_info_keyword[] = {
       "time_stamp",
       "checksums",
       "nt",
+      "nscalar",
       "gauge.previous.filename",
       "gauge.previous.time_stamp",
       "gauge.previous.checksums",
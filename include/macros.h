@@ -95,12 +95,14 @@ typedef int field_offset;
 
 // -----------------------------------------------------------------
 // Timing switches
+// The application provides timer_start and timer_stop
+// TOC also accumulates estimated flop and byte counts for timer n
 #ifdef TIMING
-#define TIC(n) tmptime[n] = -dclock();
-#define TOC(n,mytimer) tmptime[n] += dclock(); mytimer+=tmptime[n];
+#define TIC(n) timer_start(n);
+#define TOC(n, flops, bytes) timer_stop(n, flops, bytes);
 #else
 #define TIC(n)
-#define TOC(n,mytimer)
+#define TOC(n, flops, bytes)
 #endif
 
 #endif
@@ -1,5 +1,6 @@
 // -----------------------------------------------------------------
 // Return real trace of matrix products a * b and adag * b
+// d_realtrace_nn accumulates in double precision whatever the PRECISION
 #include "../include/config.h"
 #include "../include/complex.h"
 #include "../include/bQM.h"
@@ -29,4 +30,17 @@ Real realtrace(matrix *a, matrix *b) {
   }
   return sum;
 }
+
+double d_realtrace_nn(matrix *a, matrix *b) {
+  register int i, j;
+  register double sum = 0.0;
+
+  for (i = 0; i < NCOL; i++) {
+    for(j = 0; j < NCOL; j++) {
+      sum += (double)a->e[i][j].real * (double)b->e[j][i].real
+           - (double)a->e[i][j].imag * (double)b->e[j][i].imag;
+    }
+  }
+  return sum;
+}
 // -----------------------------------------------------------------
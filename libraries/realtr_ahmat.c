@@ -0,0 +1,21 @@
+// -----------------------------------------------------------------
+// Return real trace of adag * b for compressed anti-hermitian matrices
+// Each off-diagonal element appears twice in the full matrix
+// Accumulates in double precision whatever the PRECISION
+#include "../include/config.h"
+#include "../include/complex.h"
+#include "../include/bQM.h"
+
+double realtrace_ahmat(anti_hermitmat *a, anti_hermitmat *b) {
+  register int i;
+  register double diag = 0.0, offdiag = 0.0;
+
+  for (i = 0; i < NCOL; i++)
+    diag += (double)a->im_diag[i] * (double)b->im_diag[i];
+  for (i = 0; i < N_OFFDIAG; i++) {
+    offdiag += (double)a->m[i].real * (double)b->m[i].real
+             + (double)a->m[i].imag * (double)b->m[i].imag;
+  }
+  return diag + 2.0 * offdiag;
+}
+// -----------------------------------------------------------------
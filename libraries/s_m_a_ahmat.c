@@ -0,0 +1,41 @@
+// -----------------------------------------------------------------
+// Scalar multiplication and addition on compressed anti-hermitian matrices
+// c <-- s * b
+// c <-- c + s * b
+// c <-- a + s * b
+// Work directly on the NCOL * NCOL independent real components
+#include "../include/config.h"
+#include "../include/complex.h"
+#include "../include/bQM.h"
+
+void scalar_mult_ahmat(anti_hermitmat *b, Real s, anti_hermitmat *c) {
+  register int i;
+  for (i = 0; i < NCOL; i++)
+    c->im_diag[i] = s * b->im_diag[i];
+  for (i = 0; i < N_OFFDIAG; i++) {
+    c->m[i].real = s * b->m[i].real;
+    c->m[i].imag = s * b->m[i].imag;
+  }
+}
+
+void scalar_mult_sum_ahmat(anti_hermitmat *b, Real s, anti_hermitmat *c) {
+  register int i;
+  for (i = 0; i < NCOL; i++)
+    c->im_diag[i] += s * b->im_diag[i];
+  for (i = 0; i < N_OFFDIAG; i++) {
+    c->m[i].real += s * b->m[i].real;
+    c->m[i].imag += s * b->m[i].imag;
+  }
+}
+
+void scalar_mult_add_ahmat(anti_hermitmat *a, anti_hermitmat *b, Real s,
+                           anti_hermitmat *c) {
+  register int i;
+  for (i = 0; i < NCOL; i++)
+    c->im_diag[i] = a->im_diag[i] + s * b->im_diag[i];
+  for (i = 0; i < N_OFFDIAG; i++) {
+    c->m[i].real = a->m[i].real + s * b->m[i].real;
+    c->m[i].imag = a->m[i].imag + s * b->m[i].imag;
+  }
+}
+// -----------------------------------------------------------------
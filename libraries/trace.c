@@ -7,25 +7,16 @@
 complex trace(matrix *a) {
   register complex tc;
   CADD(a->e[0][0], a->e[1][1], tc);
-#if (NCOL > 2)
+#if (NCOL_PP > 2)
   CSUM(tc, a->e[2][2]);
-#if (NCOL > 3)
+#if (NCOL_PP > 3)
   CSUM(tc, a->e[3][3]);
-#if (NCOL > 4)
-  CSUM(tc, a->e[4][4]);
-#if (NCOL > 5)
-  CSUM(tc, a->e[5][5]);
-#if (NCOL > 6)
-  CSUM(tc, a->e[6][6]);
-#if (NCOL > 7)
+#if (NCOL_PP > 4)
   register int i;
-  for (i = 7; i < NCOL; i++)
+  for (i = 4; i < NCOL; i++)
     CSUM(tc, a->e[i][i]);
 #endif
 #endif
-#endif
-#endif
-#endif
 #endif
   return tc;
 }